@@ -1,4 +1,6 @@
 #include <iostream>
+#include <fstream>
+#include <string>
 #include <vector>
 #include <algorithm>
 #include <random>
@@ -6,6 +8,29 @@
 #include <limits>
 #include <tuple>
 #include <type_traits>
+#include <cstdint>
+#include <cstring>
+#include <array>
+#include <numeric>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <queue>
+#if defined(__unix__) || defined(__APPLE__)
+#define KRS_POSIX 1
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#else
+#define KRS_POSIX 0
+#endif
 #include <SFML/Graphics.hpp>
 namespace krs {
 
@@ -114,6 +139,116 @@ namespace krs {
         return (almost_equal2(s.first, p1)&& almost_equal2(s.second, p2)) || ((almost_equal2(s.first, p2) && almost_equal2(s.second, p1)));
     }
 
+#if KRS_POSIX
+    // blocking helpers for the tile worker sockets
+    inline bool writeAll(int fd, const void* data, size_t n)
+    {
+        const char* p = static_cast<const char*>(data);
+        while (n > 0) {
+            ssize_t w = write(fd, p, n);
+            if (w <= 0) {
+                return false;
+            }
+            p += w;
+            n -= static_cast<size_t>(w);
+        }
+        return true;
+    }
+    inline bool readAll(int fd, void* data, size_t n)
+    {
+        char* p = static_cast<char*>(data);
+        while (n > 0) {
+            ssize_t r = read(fd, p, n);
+            if (r <= 0) {
+                return false;
+            }
+            p += r;
+            n -= static_cast<size_t>(r);
+        }
+        return true;
+    }
+#endif
+
+    inline size_t parallel_workers(size_t n)
+    {
+        const size_t hw = std::max(1u, std::thread::hardware_concurrency());
+        return std::max<size_t>(1, std::min(hw, n / 4096));
+    }
+    // splits [0, n) into the same contiguous ranges for the same n and workers
+    template<typename F>
+    void parallel_for(size_t n, size_t workers, F f)
+    {
+        if (workers <= 1) {
+            f(size_t(0), n, size_t(0));
+            return;
+        }
+        std::vector<std::thread> pool;
+        for (size_t w = 0; w < workers; w++) {
+            pool.emplace_back(f, n * w / workers, n * (w + 1) / workers, w);
+        }
+        for (auto& t : pool) {
+            t.join();
+        }
+    }
+
+    // order-preserving unsigned keys for the floating-point bit patterns
+    inline std::uint64_t radix_key(double v)
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        return (bits >> 63) ? ~bits : bits | (std::uint64_t(1) << 63);
+    }
+    inline std::uint64_t radix_key(float v)
+    {
+        std::uint32_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        return (bits >> 31) ? ~bits : bits | (std::uint32_t(1) << 31);
+    }
+
+    // stable LSD radix sort, returns the permutation that sorts keys ascending
+    inline std::vector<size_t> radix_order(const std::vector<std::uint64_t>& keys)
+    {
+        const size_t n = keys.size();
+        const size_t workers = parallel_workers(n);
+        std::vector<size_t> order(n), next(n);
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::vector<std::array<size_t, 256>> counts(workers);
+
+        for (int shift = 0; shift < 64; shift += 8) {
+            parallel_for(n, workers, [&](size_t b, size_t e, size_t w) {
+                counts[w].fill(0);
+                for (size_t i = b; i < e; i++) {
+                    counts[w][(keys[order[i]] >> shift) & 0xff]++;
+                }
+            });
+
+            size_t sum = 0;
+            bool trivial = false;
+            for (size_t d = 0; d < 256; d++) {
+                size_t bucket = 0;
+                for (size_t w = 0; w < workers; w++) {
+                    const size_t c = counts[w][d];
+                    counts[w][d] = sum;
+                    sum += c;
+                    bucket += c;
+                }
+                trivial = trivial || bucket == n;
+            }
+            if (trivial) {
+                continue;
+            }
+
+            parallel_for(n, workers, [&](size_t b, size_t e, size_t w) {
+                auto& offset = counts[w];
+                for (size_t i = b; i < e; i++) {
+                    next[offset[(keys[order[i]] >> shift) & 0xff]++] = order[i];
+                }
+            });
+            order.swap(next);
+        }
+        return order;
+    }
+
     template<typename T>
     struct Triangle {
         using Type = T;
@@ -161,23 +296,2309 @@ namespace krs {
         const T cd = b->norm2();
         const T ef = c->norm2();
 
-        const T ax = a->x;
-        const T ay = a->y;
-        const T bx = b->x;
-        const T by = b->y;
-        const T cx = c->x;
-        const T cy = c->y;
+        const T ax = a->x;
+        const T ay = a->y;
+        const T bx = b->x;
+        const T by = b->y;
+        const T cx = c->x;
+        const T cy = c->y;
+
+        const T circum_x = (ab * (cy - by) + cd * (ay - cy) + ef * (by - ay)) / (ax * (cy - by) + bx * (ay - cy) + cx * (by - ay));
+        const T circum_y = (ab * (cx - bx) + cd * (ax - cx) + ef * (bx - ax)) / (ay * (cx - bx) + by * (ax - cx) + cy * (bx - ax));
+
+        const VertexType circum(circum_x / 2, circum_y / 2);
+        const T circum_radius = a->dist2(circum);
+        const T dist = v.dist2(circum);
+
+
+        return dist <= circum_radius;
+    };
+
+    template<typename T>
+    using Edge = std::pair<std::pair<T, T>, std::pair<T, T> >;
+
+    // Read-only window onto storage owned by someone else, typically a delaunay engine. It stays
+    // valid until that storage is next modified; materialize() takes a copy that outlives it.
+    template<typename V>
+    class View {
+        const V* _first = nullptr;
+        const V* _last = nullptr;
+
+    public:
+        using value_type = V;
+        using const_iterator = const V*;
+
+        View() = default;
+        View(const V* first, const V* last) : _first(first), _last(last) {}
+        View(const std::vector<V>& v) : _first(v.data()), _last(v.data() + v.size()) {}
+        // a view of a temporary would dangle
+        View(std::vector<V>&&) = delete;
+
+        const V* begin() const { return _first; }
+        const V* end() const { return _last; }
+        size_t size() const { return _last - _first; }
+        bool empty() const { return _first == _last; }
+        const V& operator[](size_t i) const { return _first[i]; }
+        const V& front() const { return *_first; }
+        const V& back() const { return _last[-1]; }
+        std::vector<V> materialize() const { return std::vector<V>(_first, _last); }
+    };
+
+    // > 0 when abc turns counter-clockwise, 0 within rounding error of collinear
+    template<typename T>
+    T orient2d(const Vector2<T>& a, const Vector2<T>& b, const Vector2<T>& c)
+    {
+        const T l = (b.x - a.x) * (c.y - a.y);
+        const T r = (b.y - a.y) * (c.x - a.x);
+        const T det = l - r;
+        return fabs(det) <= (fabs(l) + fabs(r)) * 1e-14 ? 0 : det;
+    }
+
+    // > 0 when d lies inside the circumcircle of the counter-clockwise triangle abc, 0 within rounding error of cocircular
+    template<typename T>
+    T incircle(const Vector2<T>& a, const Vector2<T>& b, const Vector2<T>& c, const Vector2<T>& d)
+    {
+        const T adx = a.x - d.x, ady = a.y - d.y;
+        const T bdx = b.x - d.x, bdy = b.y - d.y;
+        const T cdx = c.x - d.x, cdy = c.y - d.y;
+        const T alift = adx * adx + ady * ady;
+        const T blift = bdx * bdx + bdy * bdy;
+        const T clift = cdx * cdx + cdy * cdy;
+
+        const T det = alift * (bdx * cdy - cdx * bdy) + blift * (cdx * ady - adx * cdy) + clift * (adx * bdy - bdx * ady);
+        const T permanent = alift * (fabs(bdx * cdy) + fabs(cdx * bdy)) + blift * (fabs(cdx * ady) + fabs(adx * cdy))
+            + clift * (fabs(adx * bdy) + fabs(bdx * ady));
+        return fabs(det) <= permanent * 1e-12 ? 0 : det;
+    }
+
+    template<typename T>
+    Vector2<double> circumcenter(const Vector2<T>& a, const Vector2<T>& b, const Vector2<T>& c)
+    {
+        const double bx = double(b.x - a.x), by = double(b.y - a.y);
+        const double cx = double(c.x - a.x), cy = double(c.y - a.y);
+        const double d = 2 * (bx * cy - by * cx);
+        const double b2 = bx * bx + by * by, c2 = cx * cx + cy * cy;
+        return Vector2<double>(a.x + (cy * b2 - by * c2) / d, a.y + (bx * c2 - cx * b2) / d);
+    }
+
+    template<typename T>
+    struct Mesh
+    {
+        using Index = std::uint32_t;
+        static constexpr Index npos = std::numeric_limits<Index>::max();
+
+        std::vector<Vector2<T>> vertices;
+        // counter-clockwise vertex triples
+        std::vector<std::array<Index, 3>> triangles;
+        // neighbors[t][i] is the triangle across the edge opposite triangles[t][i], npos on the hull
+        std::vector<std::array<Index, 3>> neighbors;
+        // hull polygon, counter-clockwise
+        std::vector<Index> hull;
+        // one triangle touching each vertex, npos for vertices outside the triangulation
+        std::vector<Index> incident;
+    };
+
+    template<typename T>
+    void linkIncident(Mesh<T>& mesh)
+    {
+        mesh.incident.assign(mesh.vertices.size(), Mesh<T>::npos);
+        for (size_t t = 0; t < mesh.triangles.size(); t++) {
+            for (auto v : mesh.triangles[t]) {
+                mesh.incident[v] = typename Mesh<T>::Index(t);
+            }
+        }
+    }
+
+    template<typename T>
+    struct DelaunayReport
+    {
+        size_t vertices = 0;
+        size_t edges = 0;
+        size_t faces = 0;
+        size_t components = 0;
+        // V - E + F == 2C over the faces of the rotation system
+        bool eulerConsistent = false;
+        bool hullConvex = false;
+        // triangle areas add up to the hull area and every input point is a vertex
+        bool hullCovered = false;
+
+        std::vector<Vector2<T>> uncoveredPoints;
+        // zero-length or repeated edges
+        std::vector<Edge<T>> degenerateEdges;
+        // bounded faces that are clockwise, flat or not triangles
+        std::vector<std::vector<std::pair<T, T>>> badFaces;
+        // edges whose opposite vertex lies inside the neighbouring circumcircle
+        std::vector<Edge<T>> nonDelaunayEdges;
+
+        bool planar() const { return eulerConsistent && degenerateEdges.empty() && badFaces.empty(); }
+        bool valid() const { return planar() && hullConvex && hullCovered && nonDelaunayEdges.empty(); }
+    };
+
+    template<typename U>
+    std::ostream&
+        operator <<(std::ostream& str, const DelaunayReport<U>& r)
+    {
+        return str << "Delaunay check: " << (r.valid() ? "valid" : "INVALID") << "\n\t" <<
+            "V " << r.vertices << " E " << r.edges << " F " << r.faces << " C " << r.components <<
+            (r.eulerConsistent ? " (Euler ok)" : " (Euler mismatch)") << "\n\t" <<
+            "hull convex: " << r.hullConvex << " covered: " << r.hullCovered << " uncovered points: " << r.uncoveredPoints.size() << "\n\t" <<
+            "degenerate edges: " << r.degenerateEdges.size() << " bad faces: " << r.badFaces.size() <<
+            " non-Delaunay edges: " << r.nonDelaunayEdges.size() << '\n';
+    }
+
+    // A hull vertex only makes a reflex turn when it is off the chord of its neighbors by more
+    // than rounding, points put on hull edges (refinement) sit within it.
+    template<typename T>
+    bool hullConvex(const Mesh<T>& mesh)
+    {
+        T extent = 0;
+        for (auto& p : mesh.vertices) {
+            extent = std::max({ extent, T(fabs(p.x)), T(fabs(p.y)) });
+        }
+        const size_t m = mesh.hull.size();
+        for (size_t i = 0; i < m; i++) {
+            const auto& p = mesh.vertices[mesh.hull[(i + m - 1) % m]];
+            const auto& n = mesh.vertices[mesh.hull[(i + 1) % m]];
+            const T turn = orient2d(p, mesh.vertices[mesh.hull[i]], n);
+            if (turn < 0 && -turn > extent * T(1e-12) * std::sqrt((n.x - p.x) * (n.x - p.x) + (n.y - p.y) * (n.y - p.y))) {
+                return false;
+            }
+        }
+        return m > 0;
+    }
+
+    // Indexes an edge soup and walks the faces of its rotation system. Only the
+    // counter-clockwise triangles end up in the mesh; everything else is recorded in the report.
+    template<typename T>
+    Mesh<T> buildMesh(const std::vector<Vector2<T>>& points, View<Edge<T>> edges, DelaunayReport<T>* report = nullptr)
+    {
+        using Index = typename Mesh<T>::Index;
+        const Index npos = Mesh<T>::npos;
+        using Key = std::pair<std::uint64_t, std::uint64_t>;
+        struct KeyHash {
+            size_t operator()(const Key& k) const { return std::hash<std::uint64_t>()(k.first * 0x9e3779b97f4a7c15ull ^ k.second); }
+        };
+
+        Mesh<T> mesh;
+        DelaunayReport<T> local;
+        DelaunayReport<T>& rep = report ? *report : local;
+
+        std::unordered_map<Key, Index, KeyHash> ids;
+        ids.reserve(edges.size());
+        auto id = [&](const std::pair<T, T>& p) {
+            auto r = ids.emplace(Key(radix_key(p.first), radix_key(p.second)), Index(mesh.vertices.size()));
+            if (r.second) {
+                mesh.vertices.push_back(Vector2<T>(p.first, p.second));
+            }
+            return r.first->second;
+        };
+
+        // distinct undirected links, sorted by (min, max) index
+        std::vector<std::uint64_t> keys;
+        keys.reserve(edges.size());
+        for (auto& e : edges) {
+            const Index u = id(e.first);
+            const Index v = id(e.second);
+            if (u == v) {
+                rep.degenerateEdges.push_back(e);
+                continue;
+            }
+            keys.push_back(std::uint64_t(std::min(u, v)) << 32 | std::max(u, v));
+        }
+        std::vector<std::pair<Index, Index>> links;
+        {
+            const std::vector<size_t> order = radix_order(keys);
+            for (size_t i = 0; i < order.size(); i++) {
+                const std::uint64_t k = keys[order[i]];
+                const Index u = Index(k >> 32), v = Index(k & 0xffffffffu);
+                if (i > 0 && keys[order[i - 1]] == k) {
+                    rep.degenerateEdges.push_back({ { mesh.vertices[u].x, mesh.vertices[u].y }, { mesh.vertices[v].x, mesh.vertices[v].y } });
+                    continue;
+                }
+                links.push_back({ u, v });
+            }
+        }
+        for (auto& p : points) {
+            if (ids.find(Key(radix_key(p.x), radix_key(p.y))) == ids.end()) {
+                rep.uncoveredPoints.push_back(p);
+            }
+        }
+
+        // rotation system: neighbours of every vertex in counter-clockwise order
+        const size_t n = mesh.vertices.size();
+        std::vector<size_t> offset(n + 1, 0);
+        for (auto& l : links) {
+            offset[l.first + 1]++;
+            offset[l.second + 1]++;
+        }
+        std::partial_sum(offset.begin(), offset.end(), offset.begin());
+        const size_t halfEdges = offset[n];
+        std::vector<Index> target(halfEdges), origin(halfEdges);
+        {
+            std::vector<size_t> fill(offset.begin(), offset.end() - 1);
+            for (auto& l : links) {
+                origin[fill[l.first]] = l.first;
+                target[fill[l.first]++] = l.second;
+                origin[fill[l.second]] = l.second;
+                target[fill[l.second]++] = l.first;
+            }
+        }
+        const size_t workers = parallel_workers(std::max(n, halfEdges));
+        parallel_for(n, workers, [&](size_t b, size_t e, size_t) {
+            for (size_t v = b; v < e; v++) {
+                const Vector2<T> c = mesh.vertices[v];
+                std::sort(target.begin() + offset[v], target.begin() + offset[v + 1], [&](Index p, Index q) {
+                    return atan2(mesh.vertices[p].y - c.y, mesh.vertices[p].x - c.x) < atan2(mesh.vertices[q].y - c.y, mesh.vertices[q].x - c.x);
+                });
+            }
+        });
+
+        // next half-edge around the face on the left: clockwise successor at the head
+        std::vector<size_t> next(halfEdges), twin(halfEdges);
+        parallel_for(halfEdges, workers, [&](size_t b, size_t e, size_t) {
+            for (size_t h = b; h < e; h++) {
+                const Index u = origin[h], v = target[h];
+                size_t t = offset[v];
+                while (target[t] != u) {
+                    t++;
+                }
+                twin[h] = t;
+                next[h] = (t == offset[v] ? offset[v + 1] : t) - 1;
+            }
+        });
+
+        // triangular faces in parallel, longer cycles are walked afterwards
+        std::vector<std::vector<std::array<Index, 3>>> tris(workers), flat(workers);
+        std::vector<char> isLong(halfEdges, 0);
+        parallel_for(halfEdges, workers, [&](size_t b, size_t e, size_t w) {
+            for (size_t h = b; h < e; h++) {
+                const size_t h1 = next[h], h2 = next[h1];
+                if (next[h2] != h) {
+                    isLong[h] = 1;
+                    continue;
+                }
+                if (h > h1 || h > h2) {
+                    continue;
+                }
+                const std::array<Index, 3> t = { origin[h], origin[h1], origin[h2] };
+                if (orient2d(mesh.vertices[t[0]], mesh.vertices[t[1]], mesh.vertices[t[2]]) > 0) {
+                    tris[w].push_back(t);
+                }
+                else {
+                    flat[w].push_back(t);
+                }
+            }
+        });
+        for (auto& part : tris) {
+            mesh.triangles.insert(mesh.triangles.end(), part.begin(), part.end());
+        }
+
+        std::vector<std::vector<Index>> others;
+        for (auto& part : flat) {
+            for (auto& t : part) {
+                others.push_back({ t[0], t[1], t[2] });
+            }
+        }
+        for (size_t h = 0; h < halfEdges; h++) {
+            if (!isLong[h]) {
+                continue;
+            }
+            std::vector<Index> face;
+            for (size_t g = h; isLong[g]; g = next[g]) {
+                isLong[g] = 0;
+                face.push_back(origin[g]);
+            }
+            others.push_back(face);
+        }
+
+        // connected components
+        std::vector<Index> parent(n);
+        std::iota(parent.begin(), parent.end(), Index(0));
+        auto root = [&](Index v) {
+            while (parent[v] != v) {
+                v = parent[v] = parent[parent[v]];
+            }
+            return v;
+        };
+        size_t components = n;
+        for (auto& l : links) {
+            const Index a = root(l.first), b = root(l.second);
+            if (a != b) {
+                parent[a] = b;
+                components--;
+            }
+        }
+
+        auto area = [&](const std::vector<Index>& face) {
+            T s = 0;
+            for (size_t i = 0; i < face.size(); i++) {
+                const Vector2<T>& p = mesh.vertices[face[i]];
+                const Vector2<T>& q = mesh.vertices[face[(i + 1) % face.size()]];
+                s += p.x * q.y - q.x * p.y;
+            }
+            return s / 2;
+        };
+
+        // the most clockwise face of each component is its outer face
+        std::unordered_map<Index, size_t> outer;
+        std::vector<T> areas(others.size());
+        for (size_t f = 0; f < others.size(); f++) {
+            areas[f] = area(others[f]);
+            const Index c = root(others[f][0]);
+            auto it = outer.find(c);
+            if (areas[f] < 0 && (it == outer.end() || areas[f] < areas[it->second])) {
+                outer[c] = f;
+            }
+        }
+        size_t hullFace = others.size();
+        for (auto& o : outer) {
+            if (hullFace == others.size() || others[o.second].size() > others[hullFace].size()) {
+                hullFace = o.second;
+            }
+        }
+        for (size_t f = 0; f < others.size(); f++) {
+            const auto it = outer.find(root(others[f][0]));
+            if (it != outer.end() && it->second == f) {
+                continue;
+            }
+            std::vector<std::pair<T, T>> face;
+            for (Index v : others[f]) {
+                face.push_back({ mesh.vertices[v].x, mesh.vertices[v].y });
+            }
+            rep.badFaces.push_back(face);
+        }
+
+        if (hullFace != others.size()) {
+            mesh.hull.assign(others[hullFace].rbegin(), others[hullFace].rend());
+        }
+        rep.hullConvex = hullConvex(mesh);
+
+        // adjacency through the twin half-edges
+        std::vector<Index> faceOf(halfEdges, npos);
+        std::vector<size_t> firstHalf(mesh.triangles.size());
+        {
+            std::vector<std::pair<std::uint64_t, size_t>> lookup;
+            for (size_t h = 0; h < halfEdges; h++) {
+                lookup.push_back({ std::uint64_t(origin[h]) << 32 | target[h], h });
+            }
+            std::unordered_map<std::uint64_t, size_t> half(lookup.begin(), lookup.end());
+            for (size_t t = 0; t < mesh.triangles.size(); t++) {
+                const auto& tri = mesh.triangles[t];
+                for (int i = 0; i < 3; i++) {
+                    faceOf[half[std::uint64_t(tri[i]) << 32 | tri[(i + 1) % 3]]] = Index(t);
+                }
+                firstHalf[t] = half[std::uint64_t(tri[0]) << 32 | tri[1]];
+            }
+        }
+        mesh.neighbors.resize(mesh.triangles.size());
+        parallel_for(mesh.triangles.size(), workers, [&](size_t b, size_t e, size_t) {
+            for (size_t t = b; t < e; t++) {
+                // half-edges of t are h0 = ab, h1 = bc, h2 = ca; bc is opposite a
+                const size_t h0 = firstHalf[t], h1 = next[h0], h2 = next[h1];
+                mesh.neighbors[t] = { faceOf[twin[h1]], faceOf[twin[h2]], faceOf[twin[h0]] };
+            }
+        });
+        linkIncident(mesh);
+
+        T triArea = 0;
+        for (auto& t : mesh.triangles) {
+            triArea += orient2d(mesh.vertices[t[0]], mesh.vertices[t[1]], mesh.vertices[t[2]]) / 2;
+        }
+        const T hullArea = hullFace == others.size() ? 0 : -areas[hullFace];
+        rep.hullCovered = rep.uncoveredPoints.empty() && fabs(triArea - hullArea) <= 1e-9 * std::max<T>(hullArea, 1);
+
+        rep.vertices = n;
+        rep.edges = links.size();
+        rep.faces = mesh.triangles.size() + others.size();
+        rep.components = components;
+        rep.eulerConsistent = n == 0 || static_cast<long long>(n) - static_cast<long long>(links.size()) + static_cast<long long>(rep.faces) == 2 * static_cast<long long>(components);
+        return mesh;
+    }
+
+    template<typename T>
+    Mesh<T> buildMesh(const std::vector<Vector2<T>>& points, const std::vector<Edge<T>>& edges, DelaunayReport<T>* report = nullptr)
+    {
+        return buildMesh(points, View<Edge<T>>(edges), report);
+    }
+
+    // Certifies a triangulation given as an edge list: planarity and Euler counts from buildMesh,
+    // then the local empty-circumcircle test on every interior edge.
+    template<typename T>
+    DelaunayReport<T> verifyDelaunay(const std::vector<Vector2<T>>& points, View<Edge<T>> edges)
+    {
+        using Index = typename Mesh<T>::Index;
+        DelaunayReport<T> report;
+        const Mesh<T> mesh = buildMesh(points, edges, &report);
+
+        const size_t workers = parallel_workers(mesh.triangles.size());
+        std::vector<std::vector<Edge<T>>> found(workers);
+        parallel_for(mesh.triangles.size(), workers, [&](size_t b, size_t e, size_t w) {
+            for (size_t t = b; t < e; t++) {
+                const auto& tri = mesh.triangles[t];
+                for (int i = 0; i < 3; i++) {
+                    const Index o = mesh.neighbors[t][i];
+                    if (o == Mesh<T>::npos || o < t) {
+                        continue;
+                    }
+                    int j = 0;
+                    while (mesh.neighbors[o][j] != t) {
+                        j++;
+                    }
+                    const Vector2<T>& d = mesh.vertices[mesh.triangles[o][j]];
+                    if (incircle(mesh.vertices[tri[0]], mesh.vertices[tri[1]], mesh.vertices[tri[2]], d) > 0) {
+                        const Vector2<T>& p = mesh.vertices[tri[(i + 1) % 3]];
+                        const Vector2<T>& q = mesh.vertices[tri[(i + 2) % 3]];
+                        found[w].push_back({ { p.x, p.y }, { q.x, q.y } });
+                    }
+                }
+            }
+        });
+        for (auto& part : found) {
+            report.nonDelaunayEdges.insert(report.nonDelaunayEdges.end(), part.begin(), part.end());
+        }
+        return report;
+    }
+
+    template<typename T>
+    DelaunayReport<T> verifyDelaunay(const std::vector<Vector2<T>>& points, const std::vector<Edge<T>>& edges)
+    {
+        return verifyDelaunay(points, View<Edge<T>>(edges));
+    }
+
+    // Rebuilds neighbors and hull from the triangle list.
+    template<typename T>
+    void connectMesh(Mesh<T>& mesh)
+    {
+        using Index = typename Mesh<T>::Index;
+        // the two halves of an interior edge sort next to each other by their undirected key
+        const size_t halves = mesh.triangles.size() * 3;
+        std::vector<std::uint64_t> keys(halves);
+        for (size_t h = 0; h < halves; h++) {
+            const auto& tri = mesh.triangles[h / 3];
+            const Index a = tri[(h + 1) % 3], b = tri[(h + 2) % 3];
+            keys[h] = std::uint64_t(std::min(a, b)) << 32 | std::max(a, b);
+        }
+        const std::vector<size_t> order = radix_order(keys);
+
+        mesh.neighbors.assign(mesh.triangles.size(), { Mesh<T>::npos, Mesh<T>::npos, Mesh<T>::npos });
+        std::unordered_map<Index, Index> boundary;
+        for (size_t k = 0; k < halves; k++) {
+            const size_t h = order[k];
+            if (k + 1 < halves && keys[order[k + 1]] == keys[h]) {
+                const size_t g = order[++k];
+                mesh.neighbors[h / 3][h % 3] = Index(g / 3);
+                mesh.neighbors[g / 3][g % 3] = Index(h / 3);
+            }
+            else {
+                const auto& tri = mesh.triangles[h / 3];
+                boundary[tri[(h + 1) % 3]] = tri[(h + 2) % 3];
+            }
+        }
+
+        mesh.hull.clear();
+        if (!boundary.empty()) {
+            const Index first = boundary.begin()->first;
+            Index v = first;
+            do {
+                mesh.hull.push_back(v);
+                v = boundary[v];
+            } while (v != first && mesh.hull.size() <= boundary.size());
+        }
+        linkIncident(mesh);
+    }
+
+    inline void putVarint(std::vector<unsigned char>& buf, std::uint64_t v)
+    {
+        while (v >= 0x80) {
+            buf.push_back(static_cast<unsigned char>(v | 0x80));
+            v >>= 7;
+        }
+        buf.push_back(static_cast<unsigned char>(v));
+    }
+
+    // Binary mesh: "KRSM", version, scalar size, vertex and triangle counts, the vertices as raw
+    // coordinate pairs, then the triangles in mesh order, each rotated to start at its smallest
+    // index and stored as varints: the zigzag-coded delta of the smallest index to the previous
+    // triangle's, then the other two relative to it. The deltas stay short when neighbouring
+    // triangles have close indices, as after reorderMesh with MeshOrder::Hilbert.
+    template<typename T>
+    bool writeMesh(std::ostream& out, const Mesh<T>& mesh)
+    {
+        using Index = typename Mesh<T>::Index;
+        const size_t flushAt = 1 << 16;
+
+        const std::uint32_t version = 2;
+        const std::uint32_t scalar = sizeof(T);
+        const std::uint64_t vertexCount = mesh.vertices.size();
+        const std::uint64_t triangleCount = mesh.triangles.size();
+        out.write("KRSM", 4);
+        out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+        out.write(reinterpret_cast<const char*>(&scalar), sizeof(scalar));
+        out.write(reinterpret_cast<const char*>(&vertexCount), sizeof(vertexCount));
+        out.write(reinterpret_cast<const char*>(&triangleCount), sizeof(triangleCount));
+
+        std::vector<T> coords;
+        coords.reserve(flushAt);
+        for (auto& v : mesh.vertices) {
+            coords.push_back(v.x);
+            coords.push_back(v.y);
+            if (coords.size() >= flushAt) {
+                out.write(reinterpret_cast<const char*>(coords.data()), coords.size() * sizeof(T));
+                coords.clear();
+            }
+        }
+        out.write(reinterpret_cast<const char*>(coords.data()), coords.size() * sizeof(T));
+
+        std::vector<unsigned char> buf;
+        buf.reserve(flushAt + 32);
+        std::int64_t previous = 0;
+        for (auto& t : mesh.triangles) {
+            // the smallest index goes first, rotating keeps the winding
+            const int m = static_cast<int>(std::min_element(t.begin(), t.end()) - t.begin());
+            const Index a = t[m], b = t[(m + 1) % 3], c = t[(m + 2) % 3];
+            const std::int64_t delta = std::int64_t(a) - previous;
+            putVarint(buf, delta < 0 ? (std::uint64_t(-delta) << 1) - 1 : std::uint64_t(delta) << 1);
+            putVarint(buf, b - a);
+            putVarint(buf, c - a);
+            previous = a;
+            if (buf.size() >= flushAt) {
+                out.write(reinterpret_cast<const char*>(buf.data()), buf.size());
+                buf.clear();
+            }
+        }
+        out.write(reinterpret_cast<const char*>(buf.data()), buf.size());
+        return static_cast<bool>(out);
+    }
+
+    template<typename T>
+    bool readMesh(std::istream& in, Mesh<T>& mesh)
+    {
+        using Index = typename Mesh<T>::Index;
+
+        char magic[4];
+        std::uint32_t version = 0, scalar = 0;
+        std::uint64_t vertexCount = 0, triangleCount = 0;
+        in.read(magic, 4);
+        in.read(reinterpret_cast<char*>(&version), sizeof(version));
+        in.read(reinterpret_cast<char*>(&scalar), sizeof(scalar));
+        in.read(reinterpret_cast<char*>(&vertexCount), sizeof(vertexCount));
+        in.read(reinterpret_cast<char*>(&triangleCount), sizeof(triangleCount));
+        if (!in || std::memcmp(magic, "KRSM", 4) != 0 || (version != 1 && version != 2) || scalar != sizeof(T)
+            || vertexCount > Mesh<T>::npos || triangleCount > Mesh<T>::npos) {
+            return false;
+        }
+
+        // the counts are not trusted for allocation, the arrays grow as the data arrives
+        mesh = Mesh<T>();
+        mesh.vertices.reserve(std::min<std::uint64_t>(vertexCount, 1 << 15));
+        std::vector<T> coords(2 * std::min<std::uint64_t>(vertexCount, 1 << 15));
+        for (size_t done = 0; done < vertexCount;) {
+            const size_t n = std::min<size_t>(vertexCount - done, coords.size() / 2);
+            in.read(reinterpret_cast<char*>(coords.data()), n * 2 * sizeof(T));
+            if (!in) {
+                return false;
+            }
+            for (size_t i = 0; i < n; i++) {
+                mesh.vertices.push_back(Vector2<T>(coords[2 * i], coords[2 * i + 1]));
+            }
+            done += n;
+        }
+
+        std::vector<char> buf(1 << 16);
+        size_t pos = 0, len = 0;
+        auto byte = [&](unsigned char& c) {
+            if (pos == len) {
+                in.read(buf.data(), buf.size());
+                len = static_cast<size_t>(in.gcount());
+                pos = 0;
+                if (len == 0) {
+                    return false;
+                }
+            }
+            c = static_cast<unsigned char>(buf[pos++]);
+            return true;
+        };
+        auto varint = [&](std::uint64_t& v) {
+            v = 0;
+            unsigned char c = 0x80;
+            for (int shift = 0; (c & 0x80) && shift < 64; shift += 7) {
+                if (!byte(c)) {
+                    return false;
+                }
+                v |= std::uint64_t(c & 0x7f) << shift;
+            }
+            return !(c & 0x80);
+        };
+
+        mesh.triangles.reserve(std::min<std::uint64_t>(triangleCount, 1 << 16));
+        std::uint64_t previous = 0;
+        for (std::uint64_t i = 0; i < triangleCount; i++) {
+            std::uint64_t d0, d1, d2;
+            if (!varint(d0) || !varint(d1) || !varint(d2)) {
+                return false;
+            }
+            // version 1 sorted the triangles, its deltas never go back
+            const bool back = version != 1 && (d0 & 1);
+            const std::uint64_t step = version == 1 ? d0 : (d0 >> 1) + (d0 & 1);
+            if (step > vertexCount) {
+                return false;
+            }
+            previous = back ? previous - step : previous + step;
+            if (previous >= vertexCount || std::max(d1, d2) >= vertexCount - previous) {
+                return false;
+            }
+            mesh.triangles.push_back({ Index(previous), Index(previous + d1), Index(previous + d2) });
+        }
+        // hand back the unread tail of the buffer
+        if (pos < len) {
+            in.clear();
+            in.seekg(-static_cast<std::streamoff>(len - pos), std::ios::cur);
+        }
+        connectMesh(mesh);
+        return true;
+    }
+
+    template<typename T>
+    bool writeMeshFile(const std::string& path, const Mesh<T>& mesh)
+    {
+        std::ofstream out(path, std::ios::binary);
+        return out && writeMesh(out, mesh);
+    }
+
+    template<typename T>
+    bool readMeshFile(const std::string& path, Mesh<T>& mesh)
+    {
+        std::ifstream in(path, std::ios::binary);
+        return in && readMesh(in, mesh);
+    }
+
+    template<typename T>
+    std::vector<Edge<T>> meshEdges(const Mesh<T>& mesh)
+    {
+        std::vector<Edge<T>> edges;
+        edges.reserve(mesh.triangles.size() * 3 / 2 + mesh.hull.size());
+        for (size_t t = 0; t < mesh.triangles.size(); t++) {
+            const auto& tri = mesh.triangles[t];
+            for (int i = 0; i < 3; i++) {
+                const auto o = mesh.neighbors[t][i];
+                if (o == Mesh<T>::npos || t < o) {
+                    const Vector2<T>& p = mesh.vertices[tri[(i + 1) % 3]];
+                    const Vector2<T>& q = mesh.vertices[tri[(i + 2) % 3]];
+                    edges.push_back({ { p.x, p.y }, { q.x, q.y } });
+                }
+            }
+        }
+        return edges;
+    }
+
+    template<typename T>
+    int vertexSlot(const Mesh<T>& mesh, typename Mesh<T>::Index t, typename Mesh<T>::Index v)
+    {
+        const auto& tri = mesh.triangles[t];
+        return tri[0] == v ? 0 : (tri[1] == v ? 1 : 2);
+    }
+
+    // The triangle holding the directed edge a->b and the slot of the vertex opposite it,
+    // found by rotating around a. npos when there is no such edge.
+    template<typename T>
+    std::pair<typename Mesh<T>::Index, int> findEdge(const Mesh<T>& mesh, typename Mesh<T>::Index a, typename Mesh<T>::Index b)
+    {
+        using Index = typename Mesh<T>::Index;
+        const Index start = a < mesh.incident.size() ? mesh.incident[a] : Mesh<T>::npos;
+        if (start == Mesh<T>::npos) {
+            return { Mesh<T>::npos, 0 };
+        }
+        Index t = start;
+        do {
+            const int i = vertexSlot(mesh, t, a);
+            if (mesh.triangles[t][(i + 1) % 3] == b) {
+                return { t, (i + 2) % 3 };
+            }
+            t = mesh.neighbors[t][(i + 1) % 3];
+        } while (t != Mesh<T>::npos && t != start);
+        if (t == start) {
+            return { Mesh<T>::npos, 0 };
+        }
+        t = start;
+        for (;;) {
+            const int i = vertexSlot(mesh, t, a);
+            t = mesh.neighbors[t][(i + 2) % 3];
+            if (t == Mesh<T>::npos) {
+                return { Mesh<T>::npos, 0 };
+            }
+            const int j = vertexSlot(mesh, t, a);
+            if (mesh.triangles[t][(j + 1) % 3] == b) {
+                return { t, (j + 2) % 3 };
+            }
+        }
+    }
+
+    // Triangles around v in counter-clockwise order, starting at the hull for hull vertices.
+    // Returns true when v is interior.
+    template<typename T>
+    bool vertexStar(const Mesh<T>& mesh, typename Mesh<T>::Index v, std::vector<typename Mesh<T>::Index>& star)
+    {
+        using Index = typename Mesh<T>::Index;
+        star.clear();
+        const Index start = v < mesh.incident.size() ? mesh.incident[v] : Mesh<T>::npos;
+        if (start == Mesh<T>::npos) {
+            return false;
+        }
+        Index t = start;
+        for (;;) {
+            const Index p = mesh.neighbors[t][(vertexSlot(mesh, t, v) + 2) % 3];
+            if (p == Mesh<T>::npos) {
+                break;
+            }
+            if (p == start) {
+                t = start;
+                do {
+                    star.push_back(t);
+                    t = mesh.neighbors[t][(vertexSlot(mesh, t, v) + 1) % 3];
+                } while (t != start);
+                return true;
+            }
+            t = p;
+        }
+        while (t != Mesh<T>::npos) {
+            star.push_back(t);
+            t = mesh.neighbors[t][(vertexSlot(mesh, t, v) + 1) % 3];
+        }
+        return false;
+    }
+
+    // Replaces the removed triangles with the added ones, which must cover the same region
+    // (plus, for an empty removed list, area glued onto hull edges). Adjacency and incident
+    // triangles are relinked; leftover slots are filled from the back of the list.
+    template<typename T>
+    void replaceTriangles(Mesh<T>& mesh, const std::vector<typename Mesh<T>::Index>& removed, const std::vector<std::array<typename Mesh<T>::Index, 3>>& added)
+    {
+        using Index = typename Mesh<T>::Index;
+        const Index npos = Mesh<T>::npos;
+
+        // outer side of the removed region, keyed by the directed edge as seen from inside
+        struct Outer { Index a, b, t; bool used; };
+        std::vector<Outer> outer;
+        std::vector<Index> touched;
+        for (Index r : removed) {
+            const auto& tri = mesh.triangles[r];
+            for (int i = 0; i < 3; i++) {
+                touched.push_back(tri[i]);
+                const Index nb = mesh.neighbors[r][i];
+                if (nb == npos || std::find(removed.begin(), removed.end(), nb) == removed.end()) {
+                    outer.push_back({ tri[(i + 1) % 3], tri[(i + 2) % 3], nb, false });
+                }
+            }
+        }
+
+        std::vector<Index> slots(removed.begin(), removed.begin() + std::min(removed.size(), added.size()));
+        while (slots.size() < added.size()) {
+            slots.push_back(Index(mesh.triangles.size()));
+            mesh.triangles.push_back({ npos, npos, npos });
+            mesh.neighbors.push_back({ npos, npos, npos });
+        }
+        for (size_t k = 0; k < added.size(); k++) {
+            mesh.triangles[slots[k]] = added[k];
+            mesh.neighbors[slots[k]] = { npos, npos, npos };
+        }
+
+        auto relink = [&](Index nb, Index a, Index b, Index t) {
+            // in nb, the edge b->a now faces t
+            const auto& tri = mesh.triangles[nb];
+            for (int j = 0; j < 3; j++) {
+                if (tri[(j + 1) % 3] == b && tri[(j + 2) % 3] == a) {
+                    mesh.neighbors[nb][j] = t;
+                }
+            }
+        };
+        for (size_t k = 0; k < added.size(); k++) {
+            const Index t = slots[k];
+            const auto& tri = added[k];
+            for (int i = 0; i < 3; i++) {
+                const Index a = tri[(i + 1) % 3], b = tri[(i + 2) % 3];
+                bool found = false;
+                for (size_t m = 0; m < added.size() && !found; m++) {
+                    for (int j = 0; j < 3 && m != k; j++) {
+                        if (added[m][(j + 1) % 3] == b && added[m][(j + 2) % 3] == a) {
+                            mesh.neighbors[t][i] = slots[m];
+                            found = true;
+                            break;
+                        }
+                    }
+                }
+                for (size_t m = 0; m < outer.size() && !found; m++) {
+                    if (outer[m].a == a && outer[m].b == b) {
+                        outer[m].used = true;
+                        mesh.neighbors[t][i] = outer[m].t;
+                        if (outer[m].t != npos) {
+                            relink(outer[m].t, a, b, t);
+                        }
+                        found = true;
+                    }
+                }
+                if (!found && removed.empty()) {
+                    const auto e = findEdge(mesh, b, a);
+                    if (e.first != npos) {
+                        mesh.neighbors[t][i] = e.first;
+                        mesh.neighbors[e.first][e.second] = t;
+                    }
+                }
+            }
+        }
+        // outer edges no longer covered become hull edges
+        for (auto& o : outer) {
+            if (!o.used && o.t != npos) {
+                relink(o.t, o.a, o.b, npos);
+            }
+        }
+
+        for (Index v : touched) {
+            mesh.incident[v] = npos;
+        }
+        for (auto& o : outer) {
+            if (o.t != npos) {
+                if (mesh.incident[o.a] == npos) mesh.incident[o.a] = o.t;
+                if (mesh.incident[o.b] == npos) mesh.incident[o.b] = o.t;
+            }
+        }
+        for (size_t k = 0; k < added.size(); k++) {
+            for (Index v : added[k]) {
+                mesh.incident[v] = slots[k];
+            }
+        }
+
+        std::vector<Index> dead(removed.begin() + std::min(removed.size(), added.size()), removed.end());
+        std::sort(dead.rbegin(), dead.rend());
+        for (Index s : dead) {
+            const Index last = Index(mesh.triangles.size() - 1);
+            if (s != last) {
+                mesh.triangles[s] = mesh.triangles[last];
+                mesh.neighbors[s] = mesh.neighbors[last];
+                for (int i = 0; i < 3; i++) {
+                    const Index nb = mesh.neighbors[s][i];
+                    if (nb != npos) {
+                        for (auto& x : mesh.neighbors[nb]) {
+                            if (x == last) x = s;
+                        }
+                    }
+                    if (mesh.incident[mesh.triangles[s][i]] == last) {
+                        mesh.incident[mesh.triangles[s][i]] = s;
+                    }
+                }
+            }
+            mesh.triangles.pop_back();
+            mesh.neighbors.pop_back();
+        }
+    }
+
+    // the three edges of every triangle, to seed legalizeEdges with
+    template<typename Index>
+    std::vector<std::pair<Index, Index>> triangleEdges(const std::vector<std::array<Index, 3>>& triangles)
+    {
+        std::vector<std::pair<Index, Index>> edges;
+        edges.reserve(triangles.size() * 3);
+        for (auto& t : triangles) {
+            edges.push_back({ t[0], t[1] });
+            edges.push_back({ t[1], t[2] });
+            edges.push_back({ t[2], t[0] });
+        }
+        return edges;
+    }
+
+    // Lawson flips until every edge reachable from the seeds passes the empty-circumcircle test.
+    template<typename T>
+    size_t legalizeEdges(Mesh<T>& mesh, std::vector<std::pair<typename Mesh<T>::Index, typename Mesh<T>::Index>> stack)
+    {
+        using Index = typename Mesh<T>::Index;
+        size_t flips = 0;
+        while (!stack.empty()) {
+            const Index a = stack.back().first, b = stack.back().second;
+            stack.pop_back();
+            const auto e = findEdge(mesh, a, b);
+            if (e.first == Mesh<T>::npos) {
+                continue;
+            }
+            const Index t = e.first;
+            const Index o = mesh.neighbors[t][e.second];
+            if (o == Mesh<T>::npos) {
+                continue;
+            }
+            const Index c = mesh.triangles[t][e.second];
+            const Index w = mesh.triangles[o][(vertexSlot(mesh, o, a) + 1) % 3];
+            const auto& tri = mesh.triangles[t];
+            const auto& v = mesh.vertices;
+            if (incircle(v[tri[0]], v[tri[1]], v[tri[2]], v[w]) > 0 && orient2d(v[c], v[a], v[w]) > 0 && orient2d(v[w], v[b], v[c]) > 0) {
+                replaceTriangles(mesh, { t, o }, { { c, a, w }, { w, b, c } });
+                flips++;
+                stack.push_back({ a, w });
+                stack.push_back({ w, b });
+                stack.push_back({ b, c });
+                stack.push_back({ c, a });
+            }
+        }
+        return flips;
+    }
+
+    // Resolves ties of the empty-circle test toward the lowest vertex index: a cocircular quad
+    // keeps the diagonal touching its smallest vertex. Two Delaunay triangulations of the same
+    // numbered points then agree on every cocircular quad, as on a lattice.
+    template<typename T>
+    size_t breakCocircularTies(Mesh<T>& mesh)
+    {
+        using Index = typename Mesh<T>::Index;
+        std::vector<std::pair<Index, Index>> stack = triangleEdges(mesh.triangles);
+        size_t flips = 0;
+        while (!stack.empty()) {
+            const Index a = stack.back().first, b = stack.back().second;
+            stack.pop_back();
+            const auto e = findEdge(mesh, a, b);
+            if (e.first == Mesh<T>::npos || mesh.neighbors[e.first][e.second] == Mesh<T>::npos) {
+                continue;
+            }
+            const Index t = e.first;
+            const Index o = mesh.neighbors[t][e.second];
+            const Index c = mesh.triangles[t][e.second];
+            const Index w = mesh.triangles[o][(vertexSlot(mesh, o, a) + 1) % 3];
+            const auto& v = mesh.vertices;
+            if (std::min(c, w) < std::min(a, b) && incircle(v[a], v[b], v[c], v[w]) == 0
+                && orient2d(v[c], v[a], v[w]) > 0 && orient2d(v[w], v[b], v[c]) > 0) {
+                replaceTriangles(mesh, { t, o }, { { c, a, w }, { w, b, c } });
+                flips++;
+                stack.insert(stack.end(), { { a, w }, { w, b }, { b, c }, { c, a } });
+            }
+        }
+        return flips;
+    }
+
+    struct MeshLocation
+    {
+        enum Kind { Inside, OnEdge, OnVertex, Outside };
+        Kind kind;
+        std::uint32_t triangle;
+        // OnEdge and Outside: slot opposite the edge; OnVertex: slot of the vertex
+        int slot;
+    };
+
+    // Visibility walk from the start triangle, over a Mesh or a MeshView of one.
+    template<typename T, template<typename> class M>
+    MeshLocation locatePoint(const M<T>& mesh, const Vector2<T>& p, typename Mesh<T>::Index start = 0)
+    {
+        using Index = typename Mesh<T>::Index;
+        if (mesh.triangles.empty()) {
+            return { MeshLocation::Outside, Mesh<T>::npos, 0 };
+        }
+        Index t = start < mesh.triangles.size() ? start : 0;
+        std::uint32_t seed = 2463534242u;
+        for (size_t steps = 0; steps <= 4 * mesh.triangles.size() + 16; steps++) {
+            const auto& tri = mesh.triangles[t];
+            seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+            int zero[3], zeros = 0;
+            bool moved = false;
+            for (int k = 0; k < 3 && !moved; k++) {
+                const int i = static_cast<int>((k + seed) % 3);
+                const T o = orient2d(mesh.vertices[tri[(i + 1) % 3]], mesh.vertices[tri[(i + 2) % 3]], p);
+                if (o < 0) {
+                    if (mesh.neighbors[t][i] == Mesh<T>::npos) {
+                        return { MeshLocation::Outside, t, i };
+                    }
+                    t = mesh.neighbors[t][i];
+                    moved = true;
+                }
+                else if (o == 0) {
+                    zero[zeros++] = i;
+                }
+            }
+            if (!moved) {
+                if (zeros == 0) {
+                    return { MeshLocation::Inside, t, 0 };
+                }
+                if (zeros == 1) {
+                    return { MeshLocation::OnEdge, t, zero[0] };
+                }
+                return { MeshLocation::OnVertex, t, 3 - zero[0] - zero[1] };
+            }
+        }
+        return { MeshLocation::Outside, Mesh<T>::npos, 0 };
+    }
+
+    // Splits the edge opposite slot of triangle t, and the triangle across it, at vertex v which
+    // lies on that edge. The edges of the new vertex's link that may need flipping go to seeds.
+    template<typename T>
+    void splitEdge(Mesh<T>& mesh, typename Mesh<T>::Index t, int slot, typename Mesh<T>::Index v,
+        std::vector<std::pair<typename Mesh<T>::Index, typename Mesh<T>::Index>>& seeds)
+    {
+        using Index = typename Mesh<T>::Index;
+        const auto tri = mesh.triangles[t];
+        const Index a = tri[slot], b = tri[(slot + 1) % 3], c = tri[(slot + 2) % 3];
+        const Index o = mesh.neighbors[t][slot];
+        if (o != Mesh<T>::npos) {
+            const Index w = mesh.triangles[o][(vertexSlot(mesh, o, b) + 1) % 3];
+            replaceTriangles(mesh, { t, o }, { { a, b, v }, { a, v, c }, { w, c, v }, { w, v, b } });
+            seeds.insert(seeds.end(), { { a, b }, { c, a }, { w, c }, { b, w } });
+        }
+        else {
+            replaceTriangles(mesh, { t }, { { a, b, v }, { a, v, c } });
+            mesh.hull.insert(std::find(mesh.hull.begin(), mesh.hull.end(), c), v);
+            seeds.insert(seeds.end(), { { a, b }, { c, a } });
+        }
+    }
+
+    // Inserts p (as vertex index, or as a new vertex when index is npos) and restores the
+    // Delaunay property with flips. Returns the vertex index, npos when p is already a vertex.
+    template<typename T>
+    typename Mesh<T>::Index insertVertex(Mesh<T>& mesh, const Vector2<T>& p, typename Mesh<T>::Index start = 0,
+        typename Mesh<T>::Index index = Mesh<T>::npos, size_t* flips = nullptr)
+    {
+        using Index = typename Mesh<T>::Index;
+        const Index npos = Mesh<T>::npos;
+
+        const MeshLocation loc = locatePoint(mesh, p, start);
+        if (loc.kind == MeshLocation::OnVertex || loc.triangle == npos) {
+            return npos;
+        }
+        Index v = index;
+        if (v == npos) {
+            v = Index(mesh.vertices.size());
+            mesh.vertices.push_back(p);
+            mesh.incident.push_back(npos);
+        }
+        else {
+            mesh.vertices[v] = p;
+        }
+
+        const Index t = loc.triangle;
+        const auto tri = mesh.triangles[t];
+        const Index a = tri[loc.slot], b = tri[(loc.slot + 1) % 3], c = tri[(loc.slot + 2) % 3];
+        std::vector<std::pair<Index, Index>> seeds;
+
+        if (loc.kind == MeshLocation::Inside) {
+            replaceTriangles(mesh, { t }, { { v, b, c }, { v, c, a }, { v, a, b } });
+            seeds = { { b, c }, { c, a }, { a, b } };
+        }
+        else if (loc.kind == MeshLocation::OnEdge) {
+            splitEdge(mesh, t, loc.slot, v, seeds);
+        }
+        else {
+            // p sees a run of hull edges starting with b->c
+            const size_t h = mesh.hull.size();
+            const size_t k = std::find(mesh.hull.begin(), mesh.hull.end(), b) - mesh.hull.begin();
+            size_t lo = k, hi = (k + 1) % h;
+            auto visible = [&](size_t i) { return orient2d(mesh.vertices[mesh.hull[i]], mesh.vertices[mesh.hull[(i + 1) % h]], p) < 0; };
+            while (visible((lo + h - 1) % h) && (lo + h - 1) % h != hi) {
+                lo = (lo + h - 1) % h;
+            }
+            while (visible(hi) && hi != lo) {
+                hi = (hi + 1) % h;
+            }
+            std::vector<std::array<Index, 3>> fan;
+            for (size_t i = lo; i != hi; i = (i + 1) % h) {
+                const Index u = mesh.hull[i], w = mesh.hull[(i + 1) % h];
+                fan.push_back({ v, w, u });
+                seeds.push_back({ u, w });
+            }
+            replaceTriangles(mesh, {}, fan);
+
+            std::vector<Index> hull;
+            for (size_t i = hi; i != lo; i = (i + 1) % h) {
+                hull.push_back(mesh.hull[i]);
+            }
+            hull.push_back(mesh.hull[lo]);
+            hull.push_back(v);
+            mesh.hull.swap(hull);
+        }
+
+        const size_t n = legalizeEdges(mesh, seeds);
+        if (flips) {
+            *flips += n;
+        }
+        return v;
+    }
+
+    // Takes v out of the triangulation, filling its star by ear clipping (interior) or by a
+    // convex scan of its link (hull), then restores the Delaunay property. The vertex keeps its
+    // slot with no incident triangle. Returns false, leaving the mesh as it was, when the hole
+    // cannot be filled.
+    template<typename T>
+    bool removeVertex(Mesh<T>& mesh, typename Mesh<T>::Index v, size_t* flips = nullptr)
+    {
+        using Index = typename Mesh<T>::Index;
+        std::vector<Index> star;
+        const bool interior = vertexStar(mesh, v, star);
+        if (star.empty()) {
+            return false;
+        }
+        std::vector<Index> link;
+        for (Index t : star) {
+            link.push_back(mesh.triangles[t][(vertexSlot(mesh, t, v) + 1) % 3]);
+        }
+        if (!interior) {
+            link.push_back(mesh.triangles[star.back()][(vertexSlot(mesh, star.back(), v) + 2) % 3]);
+        }
+        const auto& pos = mesh.vertices;
+
+        std::vector<std::array<Index, 3>> added;
+        std::vector<Index> chain;
+        if (interior) {
+            std::vector<Index> poly = link;
+            while (poly.size() > 3) {
+                const size_t m = poly.size();
+                size_t ear = m;
+                for (size_t i = 0; i < m && ear == m; i++) {
+                    const Index a = poly[(i + m - 1) % m], b = poly[i], c = poly[(i + 1) % m];
+                    if (orient2d(pos[a], pos[b], pos[c]) <= 0) {
+                        continue;
+                    }
+                    bool empty = true;
+                    for (size_t j = 0; j < m && empty; j++) {
+                        const Index d = poly[j];
+                        if (d != a && d != b && d != c && orient2d(pos[a], pos[b], pos[d]) >= 0
+                            && orient2d(pos[b], pos[c], pos[d]) >= 0 && orient2d(pos[c], pos[a], pos[d]) >= 0) {
+                            empty = false;
+                        }
+                    }
+                    if (empty) {
+                        ear = i;
+                    }
+                }
+                if (ear == m) {
+                    return false;
+                }
+                added.push_back({ poly[(ear + m - 1) % m], poly[ear], poly[(ear + 1) % m] });
+                poly.erase(poly.begin() + ear);
+            }
+            if (orient2d(pos[poly[0]], pos[poly[1]], pos[poly[2]]) <= 0) {
+                return false;
+            }
+            added.push_back({ poly[0], poly[1], poly[2] });
+        }
+        else {
+            for (Index c : link) {
+                while (chain.size() >= 2 && orient2d(pos[chain[chain.size() - 2]], pos[chain.back()], pos[c]) > 0) {
+                    added.push_back({ chain[chain.size() - 2], chain.back(), c });
+                    chain.pop_back();
+                }
+                chain.push_back(c);
+            }
+            if (added.empty() && mesh.triangles.size() == star.size()) {
+                return false;
+            }
+        }
+
+        replaceTriangles(mesh, star, added);
+        if (!interior) {
+            // the hull runs prev, v, next with next = link.front() and prev = link.back()
+            auto it = std::find(mesh.hull.begin(), mesh.hull.end(), v);
+            it = mesh.hull.erase(it);
+            mesh.hull.insert(it, chain.rbegin() + 1, chain.rend() - 1);
+        }
+
+        const size_t n = legalizeEdges(mesh, triangleEdges(added));
+        if (flips) {
+            *flips += n;
+        }
+        return true;
+    }
+
+    // Incremental Delaunay triangulation of the points, vertex i of the mesh is points[i].
+    // Repeated points are left without an incident triangle.
+    template<typename T>
+    Mesh<T> triangulatePoints(const std::vector<Vector2<T>>& points)
+    {
+        using Index = typename Mesh<T>::Index;
+        Mesh<T> mesh;
+        mesh.vertices = points;
+        mesh.incident.assign(points.size(), Mesh<T>::npos);
+
+        size_t i1 = 1, i2 = 0;
+        while (i1 < points.size() && points[i1] == points[0]) {
+            i1++;
+        }
+        for (size_t i = i1 + 1; i < points.size() && i2 == 0; i++) {
+            if (orient2d(points[0], points[i1], points[i]) != 0) {
+                i2 = i;
+            }
+        }
+        if (i2 == 0) {
+            return mesh;
+        }
+        if (orient2d(points[0], points[i1], points[i2]) > 0) {
+            mesh.hull = { 0, Index(i1), Index(i2) };
+        }
+        else {
+            mesh.hull = { 0, Index(i2), Index(i1) };
+        }
+        replaceTriangles(mesh, {}, { { mesh.hull[0], mesh.hull[1], mesh.hull[2] } });
+
+        Index last = 0;
+        for (size_t i = 1; i < points.size(); i++) {
+            if (i == i1 || i == i2) {
+                continue;
+            }
+            if (insertVertex(mesh, points[i], last, Index(i)) != Mesh<T>::npos) {
+                last = mesh.incident[i];
+            }
+        }
+        return mesh;
+    }
+
+    // position of (x, y) along a Hilbert curve filling the 2^32 x 2^32 grid
+    inline std::uint64_t hilbert_key(std::uint32_t x, std::uint32_t y)
+    {
+        std::uint64_t d = 0;
+        for (std::uint32_t s = std::uint32_t(1) << 31; s > 0; s >>= 1) {
+            const std::uint32_t rx = (x & s) ? 1 : 0;
+            const std::uint32_t ry = (y & s) ? 1 : 0;
+            d += std::uint64_t(s) * s * ((3 * rx) ^ ry);
+            if (ry == 0) {
+                if (rx == 1) {
+                    x = ~x;
+                    y = ~y;
+                }
+                std::swap(x, y);
+            }
+        }
+        return d;
+    }
+
+    enum class MeshOrder
+    {
+        // vertices and triangle centroids along a Hilbert curve, for solvers sweeping neighborhoods
+        Hilbert,
+        // triangles in post-transform vertex cache order, vertices numbered by first use
+        VertexCache
+    };
+
+    // old index -> new index
+    struct MeshPermutation
+    {
+        std::vector<std::uint32_t> vertices;
+        std::vector<std::uint32_t> triangles;
+    };
+
+    // Renumbers vertices and triangles, keeping each triangle's vertex slots and adjacency.
+    template<typename T>
+    void permuteMesh(Mesh<T>& mesh, const MeshPermutation& perm)
+    {
+        using Index = typename Mesh<T>::Index;
+        const Index npos = Mesh<T>::npos;
+        Mesh<T> out;
+        out.vertices.resize(mesh.vertices.size());
+        out.incident.assign(mesh.vertices.size(), npos);
+        for (size_t v = 0; v < mesh.vertices.size(); v++) {
+            out.vertices[perm.vertices[v]] = mesh.vertices[v];
+            if (mesh.incident[v] != npos) {
+                out.incident[perm.vertices[v]] = perm.triangles[mesh.incident[v]];
+            }
+        }
+        out.triangles.resize(mesh.triangles.size());
+        out.neighbors.resize(mesh.triangles.size());
+        for (size_t t = 0; t < mesh.triangles.size(); t++) {
+            const Index to = perm.triangles[t];
+            for (int i = 0; i < 3; i++) {
+                const Index n = mesh.neighbors[t][i];
+                out.triangles[to][i] = perm.vertices[mesh.triangles[t][i]];
+                out.neighbors[to][i] = n == npos ? npos : perm.triangles[n];
+            }
+        }
+        for (Index v : mesh.hull) {
+            out.hull.push_back(perm.vertices[v]);
+        }
+        mesh = std::move(out);
+    }
+
+    template<typename T>
+    MeshPermutation hilbertOrder(const Mesh<T>& mesh)
+    {
+        MeshPermutation perm;
+        if (mesh.vertices.empty()) {
+            return perm;
+        }
+        T minx = mesh.vertices[0].x, maxx = minx, miny = mesh.vertices[0].y, maxy = miny;
+        for (auto& p : mesh.vertices) {
+            minx = std::min(minx, p.x);
+            maxx = std::max(maxx, p.x);
+            miny = std::min(miny, p.y);
+            maxy = std::max(maxy, p.y);
+        }
+        const double sx = maxx > minx ? 4294967295.0 / double(maxx - minx) : 0;
+        const double sy = maxy > miny ? 4294967295.0 / double(maxy - miny) : 0;
+        auto key = [&](double x, double y) {
+            return hilbert_key(std::uint32_t((x - double(minx)) * sx), std::uint32_t((y - double(miny)) * sy));
+        };
+
+        std::vector<std::uint64_t> keys(mesh.vertices.size());
+        for (size_t v = 0; v < keys.size(); v++) {
+            keys[v] = key(double(mesh.vertices[v].x), double(mesh.vertices[v].y));
+        }
+        std::vector<size_t> order = radix_order(keys);
+        perm.vertices.resize(order.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            perm.vertices[order[i]] = std::uint32_t(i);
+        }
+
+        keys.resize(mesh.triangles.size());
+        for (size_t t = 0; t < keys.size(); t++) {
+            const auto& a = mesh.vertices[mesh.triangles[t][0]];
+            const auto& b = mesh.vertices[mesh.triangles[t][1]];
+            const auto& c = mesh.vertices[mesh.triangles[t][2]];
+            keys[t] = key((double(a.x) + b.x + c.x) / 3, (double(a.y) + b.y + c.y) / 3);
+        }
+        order = radix_order(keys);
+        perm.triangles.resize(order.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            perm.triangles[order[i]] = std::uint32_t(i);
+        }
+        return perm;
+    }
+
+    // Greedy triangle ordering for an LRU vertex cache (Forsyth's scoring): the next triangle is
+    // the best scored one touching the cache, vertices score for being recently used and for
+    // having few triangles left. Vertices are numbered in the order the triangles first use them.
+    template<typename T>
+    MeshPermutation vertexCacheOrder(const Mesh<T>& mesh, size_t cacheSize = 32)
+    {
+        using Index = typename Mesh<T>::Index;
+        const Index npos = Mesh<T>::npos;
+        const size_t nv = mesh.vertices.size();
+        const size_t nt = mesh.triangles.size();
+        cacheSize = std::max<size_t>(cacheSize, 4);
+
+        // triangles around each vertex, the first live[v] of them not yet emitted
+        std::vector<Index> offsets(nv + 1, 0), around(nt * 3);
+        for (auto& t : mesh.triangles) {
+            for (Index v : t) {
+                offsets[v + 1]++;
+            }
+        }
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        std::vector<Index> live(nv, 0);
+        for (size_t t = 0; t < nt; t++) {
+            for (Index v : mesh.triangles[t]) {
+                around[offsets[v] + live[v]++] = Index(t);
+            }
+        }
+
+        std::vector<int> position(nv, -1);
+        auto score = [&](Index v) {
+            if (live[v] == 0) {
+                return -1.0f;
+            }
+            float s = 0;
+            const int p = position[v];
+            if (p >= 0) {
+                s = p < 3 ? 0.75f : std::pow(1.0f - float(p - 3) / float(cacheSize - 3), 1.5f);
+            }
+            return s + 2.0f / std::sqrt(float(live[v]));
+        };
+        std::vector<float> vscore(nv), tscore(nt);
+        for (size_t v = 0; v < nv; v++) {
+            vscore[v] = score(Index(v));
+        }
+        for (size_t t = 0; t < nt; t++) {
+            tscore[t] = vscore[mesh.triangles[t][0]] + vscore[mesh.triangles[t][1]] + vscore[mesh.triangles[t][2]];
+        }
+
+        MeshPermutation perm;
+        perm.vertices.assign(nv, npos);
+        perm.triangles.assign(nt, npos);
+        std::vector<Index> cache, next;
+        Index used = 0;
+        size_t cursor = 0;
+        Index best = npos;
+        for (size_t k = 0; k < nt; k++) {
+            if (best == npos) {
+                // nothing in the cache has triangles left, continue in input order
+                while (perm.triangles[cursor] != npos) {
+                    cursor++;
+                }
+                best = Index(cursor);
+            }
+            perm.triangles[best] = Index(k);
+
+            next.clear();
+            for (Index v : mesh.triangles[best]) {
+                if (perm.vertices[v] == npos) {
+                    perm.vertices[v] = used++;
+                }
+                Index* first = around.data() + offsets[v];
+                std::swap(*std::find(first, first + live[v], best), first[live[v] - 1]);
+                live[v]--;
+                next.push_back(v);
+            }
+            for (Index v : cache) {
+                if (std::find(next.begin(), next.begin() + 3, v) == next.begin() + 3) {
+                    next.push_back(v);
+                }
+            }
+            for (size_t i = 0; i < next.size(); i++) {
+                position[next[i]] = i < cacheSize ? int(i) : -1;
+                vscore[next[i]] = score(next[i]);
+            }
+
+            best = npos;
+            float bestScore = -1;
+            for (size_t i = 0; i < next.size(); i++) {
+                const Index v = next[i];
+                for (Index j = offsets[v]; j < offsets[v] + live[v]; j++) {
+                    const Index t = around[j];
+                    tscore[t] = vscore[mesh.triangles[t][0]] + vscore[mesh.triangles[t][1]] + vscore[mesh.triangles[t][2]];
+                    if (i < cacheSize && tscore[t] > bestScore) {
+                        bestScore = tscore[t];
+                        best = t;
+                    }
+                }
+            }
+            next.resize(std::min(next.size(), cacheSize));
+            cache.swap(next);
+        }
+
+        // vertices outside the triangulation go last, in their old order
+        for (size_t v = 0; v < nv; v++) {
+            if (perm.vertices[v] == npos) {
+                perm.vertices[v] = used++;
+            }
+        }
+        return perm;
+    }
+
+    // Renumbers the mesh for locality and returns the permutation that was applied, so per-vertex
+    // and per-triangle data kept elsewhere can follow.
+    template<typename T>
+    MeshPermutation reorderMesh(Mesh<T>& mesh, MeshOrder order)
+    {
+        const MeshPermutation perm = order == MeshOrder::Hilbert ? hilbertOrder(mesh) : vertexCacheOrder(mesh);
+        permuteMesh(mesh, perm);
+        return perm;
+    }
+
+    struct RefinementOptions
+    {
+        // smallest angle in degrees a triangle may keep, 0 turns the test off; termination is
+        // only guaranteed up to about 20.7
+        double minAngle = 20;
+        // largest area a triangle may keep, 0 turns the test off
+        double maxArea = 0;
+        // Steiner points allowed before giving up, guards small angles between hull edges
+        size_t maxInsertions = std::numeric_limits<size_t>::max();
+    };
+
+    struct RefinementStats
+    {
+        // circumcenters inserted
+        size_t inserted = 0;
+        // hull edges split at their midpoint instead
+        size_t split = 0;
+        size_t flips = 0;
+        // false when maxInsertions ran out with bad triangles left
+        bool complete = true;
+    };
+
+    // Delaunay refinement in the manner of Ruppert and Chew with the hull as the only segments.
+    // Bad triangles wait in a priority queue, worst first, and get their circumcenter inserted
+    // in place. A circumcenter beyond the hull, or inside the diametral circle of a hull edge
+    // next to it, splits that hull edge instead. Only the new vertex's star is requeued.
+    template<typename T>
+    RefinementStats refineMesh(Mesh<T>& mesh, const RefinementOptions& options)
+    {
+        using Index = typename Mesh<T>::Index;
+        const Index npos = Mesh<T>::npos;
+        RefinementStats stats;
+        if (mesh.triangles.empty()) {
+            return stats;
+        }
+
+        // circumradius over shortest edge of a triangle at the minimum angle
+        const double pi = 3.14159265358979323846;
+        const double sine = std::sin(std::min(options.minAngle, 60.0) * pi / 180);
+        const double bound = options.minAngle > 0 ? 1 / (2 * sine) : 0;
+        double extent = 0;
+        for (auto& p : mesh.vertices) {
+            extent = std::max({ extent, std::fabs(double(p.x)), std::fabs(double(p.y)) });
+        }
+        // edges this short are left alone, refinement near them would only chase rounding
+        const double shortest = extent * 1e-9;
+
+        // worst of the two bounds, above 1 is bad
+        auto badness = [&](Index t) {
+            const auto& a = mesh.vertices[mesh.triangles[t][0]];
+            const auto& b = mesh.vertices[mesh.triangles[t][1]];
+            const auto& c = mesh.vertices[mesh.triangles[t][2]];
+            const double ab = double(b.x - a.x) * (b.x - a.x) + double(b.y - a.y) * (b.y - a.y);
+            const double bc = double(c.x - b.x) * (c.x - b.x) + double(c.y - b.y) * (c.y - b.y);
+            const double ca = double(a.x - c.x) * (a.x - c.x) + double(a.y - c.y) * (a.y - c.y);
+            const double area = orient2d(a, b, c) / 2;
+            const double lmin = std::min({ ab, bc, ca });
+            if (area <= 0 || lmin <= shortest * shortest) {
+                return 0.0;
+            }
+            double worst = 0;
+            if (bound > 0) {
+                // R = |ab| |bc| |ca| / 4A
+                worst = std::sqrt(ab * bc * ca / (16 * area * area * lmin)) / bound;
+            }
+            if (options.maxArea > 0) {
+                worst = std::max(worst, area / options.maxArea);
+            }
+            return worst;
+        };
+
+        struct Bad
+        {
+            double badness;
+            Index a, b, c;
+            bool operator<(const Bad& o) const { return badness < o.badness; }
+        };
+        std::priority_queue<Bad> queue;
+        auto consider = [&](Index t) {
+            const double q = badness(t);
+            if (q > 1) {
+                queue.push({ q, mesh.triangles[t][0], mesh.triangles[t][1], mesh.triangles[t][2] });
+            }
+        };
+        for (Index t = 0; t < mesh.triangles.size(); t++) {
+            consider(t);
+        }
+
+        // hull edge opposite slot of t when p lies in its diametral circle
+        auto encroached = [&](Index t, int slot, const Vector2<T>& p) {
+            if (mesh.neighbors[t][slot] != npos) {
+                return false;
+            }
+            const auto& u = mesh.vertices[mesh.triangles[t][(slot + 1) % 3]];
+            const auto& w = mesh.vertices[mesh.triangles[t][(slot + 2) % 3]];
+            return double(u.x - p.x) * (w.x - p.x) + double(u.y - p.y) * (w.y - p.y) < 0;
+        };
+
+        std::vector<std::pair<Index, Index>> seeds;
+        std::vector<Index> star;
+        while (!queue.empty()) {
+            const Bad bad = queue.top();
+            queue.pop();
+            // triangles are renumbered as the mesh changes, find it again by its edge
+            const auto edge = findEdge(mesh, bad.a, bad.b);
+            const Index t = edge.first;
+            if (t == npos || mesh.triangles[t][edge.second] != bad.c) {
+                continue;
+            }
+            if (stats.inserted + stats.split >= options.maxInsertions) {
+                stats.complete = false;
+                break;
+            }
+
+            const Vector2<double> o = circumcenter(mesh.vertices[bad.a], mesh.vertices[bad.b], mesh.vertices[bad.c]);
+            const Vector2<T> center(T(o.x), T(o.y));
+
+            MeshLocation loc = locatePoint(mesh, center, t);
+            Index host = loc.triangle;
+            int slot = loc.slot;
+            bool split = loc.kind == MeshLocation::Outside;
+            for (int i = 0; i < 3 && !split && loc.kind != MeshLocation::OnVertex; i++) {
+                if (encroached(t, i, center)) {
+                    host = t;
+                    slot = i;
+                    split = true;
+                }
+                else if (loc.kind != MeshLocation::Outside && encroached(loc.triangle, i, center)) {
+                    host = loc.triangle;
+                    slot = i;
+                    split = true;
+                }
+            }
+
+            Index v = npos;
+            seeds.clear();
+            if (split && host != npos) {
+                const auto& u = mesh.vertices[mesh.triangles[host][(slot + 1) % 3]];
+                const auto& w = mesh.vertices[mesh.triangles[host][(slot + 2) % 3]];
+                v = Index(mesh.vertices.size());
+                mesh.vertices.push_back(Vector2<T>((u.x + w.x) / 2, (u.y + w.y) / 2));
+                mesh.incident.push_back(npos);
+                splitEdge(mesh, host, slot, v, seeds);
+                stats.flips += legalizeEdges(mesh, seeds);
+                stats.split++;
+                // the triangle may have survived the split, it is dropped later if not
+                queue.push(bad);
+            }
+            else if (!split && loc.kind != MeshLocation::OnVertex) {
+                v = insertVertex(mesh, center, t, npos, &stats.flips);
+                if (v != npos) {
+                    stats.inserted++;
+                }
+            }
+            if (v == npos) {
+                continue;
+            }
+
+            // every triangle the insertion created touches v
+            vertexStar(mesh, v, star);
+            for (Index s : star) {
+                consider(s);
+            }
+        }
+        return stats;
+    }
+
+    template<typename T>
+    struct Contour
+    {
+        T level;
+        // high values on the left; a closed line repeats its first point at the end
+        std::vector<std::vector<Vector2<T>>> lines;
+    };
+
+    // Isolines of a per-vertex scalar field at every level (sorted ascending in the result). A
+    // vertex at a level counts as above it. Triangles are bucketed by the levels their value
+    // range spans, then each level is traced on its own thread by walking the triangles through
+    // their adjacency: in from the edge whose tail is above, out through the other crossing edge.
+    template<typename T>
+    std::vector<Contour<T>> contourMesh(const Mesh<T>& mesh, const std::vector<T>& values, std::vector<T> levels)
+    {
+        using Index = typename Mesh<T>::Index;
+        const Index npos = Mesh<T>::npos;
+        std::sort(levels.begin(), levels.end());
+        levels.erase(std::unique(levels.begin(), levels.end()), levels.end());
+        std::vector<Contour<T>> result(levels.size());
+        for (size_t l = 0; l < levels.size(); l++) {
+            result[l].level = levels[l];
+        }
+        const size_t nt = mesh.triangles.size();
+        if (levels.empty() || nt == 0 || values.size() < mesh.vertices.size()) {
+            return result;
+        }
+
+        // levels L with min < L <= max of the triangle
+        auto span = [&](Index t) {
+            const auto& tri = mesh.triangles[t];
+            const T lo = std::min({ values[tri[0]], values[tri[1]], values[tri[2]] });
+            const T hi = std::max({ values[tri[0]], values[tri[1]], values[tri[2]] });
+            return std::make_pair(std::upper_bound(levels.begin(), levels.end(), lo) - levels.begin(),
+                std::upper_bound(levels.begin(), levels.end(), hi) - levels.begin());
+        };
+
+        // triangles of each level in index order, each worker fills its own run of every bucket
+        const size_t workers = parallel_workers(nt);
+        const size_t nl = levels.size();
+        std::vector<size_t> offsets(workers * nl + 1, 0);
+        parallel_for(nt, workers, [&](size_t b, size_t e, size_t w) {
+            for (size_t t = b; t < e; t++) {
+                const auto r = span(Index(t));
+                for (auto l = r.first; l < r.second; l++) {
+                    offsets[l * workers + w + 1]++;
+                }
+            }
+        });
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        std::vector<Index> buckets(offsets.back());
+        parallel_for(nt, workers, [&](size_t b, size_t e, size_t w) {
+            std::vector<size_t> fill(nl);
+            for (size_t l = 0; l < nl; l++) {
+                fill[l] = offsets[l * workers + w];
+            }
+            for (size_t t = b; t < e; t++) {
+                const auto r = span(Index(t));
+                for (auto l = r.first; l < r.second; l++) {
+                    buckets[fill[l]++] = Index(t);
+                }
+            }
+        });
+
+        std::atomic<size_t> nextLevel{ 0 };
+        parallel_for(workers, workers, [&](size_t, size_t, size_t) {
+            std::vector<char> visited;
+            for (size_t l = nextLevel++; l < nl; l = nextLevel++) {
+                const T level = levels[l];
+                const Index* first = buckets.data() + offsets[l * workers];
+                const Index* last = buckets.data() + offsets[(l + 1) * workers];
+                visited.assign(last - first, 0);
+                auto above = [&](Index v) { return values[v] >= level; };
+                // slot opposite the edge a->b of t with a above and b below (entry), or the reverse (exit)
+                auto crossing = [&](Index t, bool entry) {
+                    const auto& tri = mesh.triangles[t];
+                    for (int i = 0; i < 3; i++) {
+                        if (above(tri[(i + 1) % 3]) == entry && above(tri[(i + 2) % 3]) != entry) {
+                            return i;
+                        }
+                    }
+                    return -1;
+                };
+                // the same point whichever side of the edge asks
+                auto point = [&](Index t, int slot) {
+                    Index a = mesh.triangles[t][(slot + 1) % 3], b = mesh.triangles[t][(slot + 2) % 3];
+                    if (a > b) {
+                        std::swap(a, b);
+                    }
+                    const T f = (level - values[a]) / (values[b] - values[a]);
+                    const auto& p = mesh.vertices[a];
+                    const auto& q = mesh.vertices[b];
+                    return Vector2<T>(p.x + f * (q.x - p.x), p.y + f * (q.y - p.y));
+                };
+                auto mark = [&](Index t) {
+                    char& seen = visited[std::lower_bound(first, last, t) - first];
+                    const bool fresh = !seen;
+                    seen = 1;
+                    return fresh;
+                };
+                auto trace = [&](Index t) {
+                    std::vector<Vector2<T>> line = { point(t, crossing(t, true)) };
+                    while (t != npos && mark(t)) {
+                        const int out = crossing(t, false);
+                        line.push_back(point(t, out));
+                        t = mesh.neighbors[t][out];
+                    }
+                    result[l].lines.push_back(std::move(line));
+                };
+
+                // open lines start on the hull, what is left are closed loops
+                for (const Index* t = first; t != last; t++) {
+                    if (mesh.neighbors[*t][crossing(*t, true)] == npos) {
+                        trace(*t);
+                    }
+                }
+                for (const Index* t = first; t != last; t++) {
+                    if (!visited[t - first]) {
+                        trace(*t);
+                    }
+                }
+            }
+        });
+        return result;
+    }
+
+    // Delaunay triangulation of points[ids] inserted in Hilbert order, vertex k of the mesh is
+    // points[ids[k]]. Of equal points only the first listed is linked. With ids ascending,
+    // cocircular ties go the same way for every subset holding the points of the circle.
+    template<typename T>
+    Mesh<T> triangulateSubset(const std::vector<Vector2<T>>& points, const std::vector<typename Mesh<T>::Index>& ids)
+    {
+        Mesh<T> mesh;
+        mesh.vertices.reserve(ids.size());
+        for (auto i : ids) {
+            mesh.vertices.push_back(points[i]);
+        }
+        const MeshPermutation order = hilbertOrder(mesh);
+        std::vector<Vector2<T>> sorted(ids.size());
+        MeshPermutation back;
+        back.vertices.resize(ids.size());
+        for (size_t k = 0; k < ids.size(); k++) {
+            sorted[order.vertices[k]] = mesh.vertices[k];
+            back.vertices[order.vertices[k]] = std::uint32_t(k);
+        }
+        mesh = triangulatePoints(sorted);
+        back.triangles.resize(mesh.triangles.size());
+        std::iota(back.triangles.begin(), back.triangles.end(), std::uint32_t(0));
+        permuteMesh(mesh, back);
+        breakCocircularTies(mesh);
+        return mesh;
+    }
+
+    // True when the triangles of a connected mesh (connectMesh) tile the convex hull of its
+    // linked vertices: every triangle counter-clockwise, every edge used once per direction, one
+    // convex boundary cycle and the Euler count of a disc. Together these rule out overlaps.
+    template<typename T>
+    bool isTriangulation(const Mesh<T>& mesh)
+    {
+        using Index = typename Mesh<T>::Index;
+        const size_t halves = mesh.triangles.size() * 3;
+        std::vector<std::uint64_t> keys(halves);
+        for (size_t h = 0; h < halves; h++) {
+            const auto& tri = mesh.triangles[h / 3];
+            if (h % 3 == 0 && orient2d(mesh.vertices[tri[0]], mesh.vertices[tri[1]], mesh.vertices[tri[2]]) <= 0) {
+                return false;
+            }
+            const Index a = tri[(h + 1) % 3], b = tri[(h + 2) % 3];
+            keys[h] = std::uint64_t(std::min(a, b)) << 32 | std::max(a, b);
+        }
+        // an edge is used once (hull) or twice in opposite directions
+        const std::vector<size_t> order = radix_order(keys);
+        auto forward = [&](size_t h) { return mesh.triangles[h / 3][(h + 1) % 3] < mesh.triangles[h / 3][(h + 2) % 3]; };
+        size_t boundary = 0;
+        for (size_t k = 0; k < halves; k++) {
+            const size_t h = order[k];
+            const size_t same = k + 1 < halves && keys[order[k + 1]] == keys[h] ? (k + 2 < halves && keys[order[k + 2]] == keys[h] ? 3 : 2) : 1;
+            if (same == 3 || (same == 2 && forward(h) == forward(order[k + 1]))) {
+                return false;
+            }
+            boundary += same == 1;
+            k += same - 1;
+        }
+        size_t linked = 0;
+        for (auto t : mesh.incident) {
+            linked += t != Mesh<T>::npos;
+        }
+        return !mesh.triangles.empty() && mesh.hull.size() == boundary
+            && linked + mesh.triangles.size() == (3 * mesh.triangles.size() + boundary) / 2 + 1 && hullConvex(mesh);
+    }
+
+    class CancellationToken
+    {
+        std::atomic<bool> _cancelled{ false };
+    public:
+        void cancel() { _cancelled.store(true, std::memory_order_relaxed); }
+        bool cancelled() const { return _cancelled.load(std::memory_order_relaxed); }
+    };
+
+    struct TriangulationOptions
+    {
+        const CancellationToken* token = nullptr;
+        // zero means no time limit
+        std::chrono::steady_clock::duration budget = std::chrono::steady_clock::duration::zero();
+        // called after every merge with (merges done, merges total)
+        std::function<void(size_t, size_t)> progress;
+    };
+
+    // where delaunay::getMesh() took its mesh from
+    enum class MeshSource
+    {
+        // nothing triangulated yet
+        None,
+        // the triangles of the merge output, which was already Delaunay
+        Edges,
+        // the merge output made Delaunay with edge flips
+        Flipped,
+        // the merge output was not a triangulation, its vertices were triangulated again
+        Retriangulated,
+        // a snapshot's mesh
+        Snapshot
+    };
+
+    struct KineticStats
+    {
+        size_t moved = 0;
+        size_t flips = 0;
+        // vertices that crossed a triangle and were removed and reinserted
+        size_t relocated = 0;
+        // the mesh had to be triangulated again from scratch
+        bool rebuilt = false;
+    };
+
+    struct TriangulationStatus
+    {
+        bool complete = false;
+        bool cancelled = false;
+        bool expired = false;
+        size_t levelsDone = 0;
+        size_t levels = 0;
+        size_t mergesDone = 0;
+        size_t mergesTotal = 0;
+        // [first, second) chunks of the presorted vertices as the last finished level left them,
+        // each one triangulated on its own. A single range once complete.
+        std::vector<std::pair<size_t, size_t>> regions;
+    };
+
+    // Delaunay edges of exactly N points, from every triple whose circumcircle holds none of
+    // the others. All loops run over template parameters, so each size compiles to straight-line code.
+    template<typename T, size_t N>
+    struct BaseCase
+    {
+        static constexpr size_t triples = N < 3 ? 0 : N * (N - 1) * (N - 2) / 6;
+
+        static constexpr std::array<std::array<std::uint8_t, 3>, triples> table()
+        {
+            std::array<std::array<std::uint8_t, 3>, triples> t{};
+            size_t n = 0;
+            for (size_t i = 0; i < N; i++) {
+                for (size_t j = i + 1; j < N; j++) {
+                    for (size_t k = j + 1; k < N; k++) {
+                        t[n][0] = std::uint8_t(i);
+                        t[n][1] = std::uint8_t(j);
+                        t[n][2] = std::uint8_t(k);
+                        n++;
+                    }
+                }
+            }
+            return t;
+        }
+
+        static constexpr std::uint64_t bit(size_t i, size_t j) { return std::uint64_t(1) << (i * N + j); }
+
+        template<size_t A, size_t B, size_t C, size_t... D>
+        static bool empty(const Vector2<T>* v, bool ccw, std::index_sequence<D...>)
+        {
+            return ((D == A || D == B || D == C || (ccw ? incircle(v[A], v[B], v[C], v[D]) : incircle(v[A], v[C], v[B], v[D])) <= 0) && ...);
+        }
+
+        template<size_t A, size_t B, size_t C>
+        static void test(const Vector2<T>* v, std::uint64_t& adj)
+        {
+            const T o = orient2d(v[A], v[B], v[C]);
+            if (o != 0 && empty<A, B, C>(v, o > 0, std::make_index_sequence<N>())) {
+                adj |= bit(A, B) | bit(B, C) | bit(A, C);
+            }
+        }
+
+        template<size_t... K>
+        static std::uint64_t accept([[maybe_unused]] const Vector2<T>* v, std::index_sequence<K...>)
+        {
+            if constexpr (triples == 0) {
+                return 0;
+            }
+            else {
+                constexpr auto tri = table();
+                std::uint64_t adj = 0;
+                (test<tri[K][0], tri[K][1], tri[K][2]>(v, adj), ...);
+                return adj;
+            }
+        }
+
+        static void triangulate(const Vector2<T>* v, std::vector<Edge<T>>& out)
+        {
+            const std::uint64_t adj = accept(v, std::make_index_sequence<triples>());
+            auto edge = [&](size_t i, size_t j) { out.push_back({ { v[i].x, v[i].y }, { v[j].x, v[j].y } }); };
+
+            if (adj == 0) {
+                // collinear: chain the points along the line
+                std::array<size_t, N> order;
+                std::iota(order.begin(), order.end(), size_t(0));
+                std::sort(order.begin(), order.end(), [&](size_t i, size_t j) { return v[i].x < v[j].x || (v[i].x == v[j].x && v[i].y < v[j].y); });
+                for (size_t i = 1; i < N; i++) {
+                    if (!(v[order[i - 1]] == v[order[i]])) {
+                        edge(order[i - 1], order[i]);
+                    }
+                }
+                return;
+            }
+
+            // cocircular points can accept both diagonals of a quad, keep the first
+            std::array<std::pair<size_t, size_t>, N * (N - 1) / 2 + 1> kept;
+            size_t count = 0;
+            for (size_t i = 0; i < N; i++) {
+                for (size_t j = i + 1; j < N; j++) {
+                    if (!(adj & bit(i, j))) {
+                        continue;
+                    }
+                    bool crosses = false;
+                    for (size_t k = 0; k < count && !crosses; k++) {
+                        const size_t c = kept[k].first, d = kept[k].second;
+                        crosses = c != i && c != j && d != i && d != j
+                            && orient2d(v[i], v[j], v[c]) * orient2d(v[i], v[j], v[d]) < 0
+                            && orient2d(v[c], v[d], v[i]) * orient2d(v[c], v[d], v[j]) < 0;
+                    }
+                    if (!crosses) {
+                        kept[count++] = { i, j };
+                        edge(i, j);
+                    }
+                }
+            }
+        }
+    };
+
+    template<typename T>
+    using BaseCaseSolver = void (*)(const Vector2<T>*, std::vector<Edge<T>>&);
+
+    template<typename T, size_t... N>
+    constexpr std::array<BaseCaseSolver<T>, sizeof...(N)> baseCaseTable(std::index_sequence<N...>)
+    {
+        return { { &BaseCase<T, N>::triangulate... } };
+    }
+
+    // Mesh arrays owned elsewhere, such as a mapped snapshot.
+    template<typename T>
+    struct MeshView
+    {
+        using Index = typename Mesh<T>::Index;
+        View<Vector2<T>> vertices;
+        View<std::array<Index, 3>> triangles;
+        View<std::array<Index, 3>> neighbors;
+        View<Index> hull;
+        View<Index> incident;
+    };
+
+    // Snapshot file: this header, then the vertices, triangles, neighbors, hull, incident
+    // triangles and location grid cells as raw arrays in native byte order, each 8-byte aligned
+    // so a mapped file can be used in place. The grid covers the vertex bounds and each cell
+    // names a triangle near it to start point location from.
+    struct SnapshotHeader
+    {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t scalarSize;
+        std::uint32_t indexSize;
+        std::uint64_t vertices;
+        std::uint64_t triangles;
+        std::uint64_t hull;
+        std::uint64_t gridCols;
+        std::uint64_t gridRows;
+        double gridX;
+        double gridY;
+        double cellW;
+        double cellH;
+        // byte offsets of the six arrays, in the order above
+        std::uint64_t sections[6];
+        std::uint64_t size;
+    };
+
+    // The mesh must be connected (connectMesh), a missing neighbors or incident array is
+    // rejected since the header has no count of its own for them.
+    template<typename T>
+    bool writeSnapshot(std::ostream& out, const Mesh<T>& mesh)
+    {
+        using Index = typename Mesh<T>::Index;
+        static_assert(sizeof(Vector2<T>) == 2 * sizeof(T) && std::is_trivially_copyable<Vector2<T>>::value, "vertices are stored raw");
+        if (mesh.neighbors.size() != mesh.triangles.size() || mesh.incident.size() != mesh.vertices.size()) {
+            return false;
+        }
+
+        SnapshotHeader header = {};
+        std::memcpy(header.magic, "KRSS", 4);
+        header.version = 1;
+        header.scalarSize = sizeof(T);
+        header.indexSize = sizeof(Index);
+        header.vertices = mesh.vertices.size();
+        header.triangles = mesh.triangles.size();
+        header.hull = mesh.hull.size();
+
+        // about two triangles per cell, shaped like the bounds
+        double minx = 0, miny = 0, maxx = 0, maxy = 0;
+        if (!mesh.vertices.empty()) {
+            minx = maxx = mesh.vertices[0].x;
+            miny = maxy = mesh.vertices[0].y;
+        }
+        for (auto& p : mesh.vertices) {
+            minx = std::min<double>(minx, p.x);
+            maxx = std::max<double>(maxx, p.x);
+            miny = std::min<double>(miny, p.y);
+            maxy = std::max<double>(maxy, p.y);
+        }
+        const double w = maxx - minx, h = maxy - miny;
+        const double cells = std::max<double>(1, double(mesh.triangles.size()) / 2);
+        header.gridCols = std::max<std::uint64_t>(1, std::uint64_t(w > 0 && h > 0 ? std::sqrt(cells * w / h) : 1));
+        header.gridRows = std::max<std::uint64_t>(1, std::uint64_t(cells / header.gridCols));
+        header.gridX = minx;
+        header.gridY = miny;
+        header.cellW = w > 0 ? w / header.gridCols : 1;
+        header.cellH = h > 0 ? h / header.gridRows : 1;
+
+        std::vector<Index> grid(header.gridCols * header.gridRows, Mesh<T>::npos);
+        for (size_t t = 0; t < mesh.triangles.size(); t++) {
+            const auto& tri = mesh.triangles[t];
+            const double cx = (double(mesh.vertices[tri[0]].x) + mesh.vertices[tri[1]].x + mesh.vertices[tri[2]].x) / 3;
+            const double cy = (double(mesh.vertices[tri[0]].y) + mesh.vertices[tri[1]].y + mesh.vertices[tri[2]].y) / 3;
+            const std::uint64_t col = std::min<std::uint64_t>(header.gridCols - 1, std::uint64_t(std::max(0.0, (cx - minx) / header.cellW)));
+            const std::uint64_t row = std::min<std::uint64_t>(header.gridRows - 1, std::uint64_t(std::max(0.0, (cy - miny) / header.cellH)));
+            grid[row * header.gridCols + col] = Index(t);
+        }
+        // empty cells borrow the last filled one before them
+        Index last = 0;
+        for (auto& c : grid) {
+            c = c == Mesh<T>::npos ? last : c;
+            last = c;
+        }
+
+        const std::uint64_t bytes[6] = {
+            mesh.vertices.size() * sizeof(Vector2<T>), mesh.triangles.size() * sizeof(std::array<Index, 3>),
+            mesh.neighbors.size() * sizeof(std::array<Index, 3>), mesh.hull.size() * sizeof(Index),
+            mesh.incident.size() * sizeof(Index), grid.size() * sizeof(Index) };
+        const char* data[6] = {
+            reinterpret_cast<const char*>(mesh.vertices.data()), reinterpret_cast<const char*>(mesh.triangles.data()),
+            reinterpret_cast<const char*>(mesh.neighbors.data()), reinterpret_cast<const char*>(mesh.hull.data()),
+            reinterpret_cast<const char*>(mesh.incident.data()), reinterpret_cast<const char*>(grid.data()) };
+        std::uint64_t offset = sizeof(SnapshotHeader);
+        for (int i = 0; i < 6; i++) {
+            header.sections[i] = offset;
+            offset = (offset + bytes[i] + 7) & ~std::uint64_t(7);
+        }
+        header.size = offset;
+
+        const char padding[8] = {};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (int i = 0; i < 6; i++) {
+            out.write(data[i], bytes[i]);
+            out.write(padding, (8 - bytes[i] % 8) % 8);
+        }
+        return static_cast<bool>(out);
+    }
+
+    template<typename T>
+    bool writeSnapshotFile(const std::string& path, const Mesh<T>& mesh)
+    {
+        std::ofstream out(path, std::ios::binary);
+        return out && writeSnapshot(out, mesh);
+    }
+
+    // A snapshot file mapped read-only. mesh() and locate() work on the mapping directly, so
+    // opening only checks the header and the location grid; pages load as queries touch them.
+    // Without POSIX the file is read into memory instead. The mesh arrays are trusted, call
+    // validate() on files that may be corrupt before walking them.
+    template<typename T>
+    class MeshSnapshot {
+        const char* _base = nullptr;
+        size_t _size = 0;
+        // the file contents where it cannot be mapped
+        std::vector<std::uint64_t> _buffer;
+        SnapshotHeader _header = {};
+        MeshView<T> _mesh;
+
+    public:
+        MeshSnapshot() = default;
+        MeshSnapshot(const MeshSnapshot&) = delete;
+        MeshSnapshot(MeshSnapshot&& other) noexcept { *this = std::move(other); }
+        ~MeshSnapshot() { close(); }
+        MeshSnapshot& operator=(const MeshSnapshot&) = delete;
+        MeshSnapshot& operator=(MeshSnapshot&& other) noexcept;
+
+        bool open(const std::string& path);
+        void close();
+        bool isOpen() const { return _base != nullptr; }
+        const MeshView<T>& mesh() const { return _mesh; }
+        MeshLocation locate(const Vector2<T>& p) const;
+        // every vertex, triangle and neighbor index in range, a full pass over the mesh
+        bool validate() const;
+        // a mutable copy, for editing or handing to a delaunay engine
+        Mesh<T> materialize() const;
+    };
+
+    template<typename T>
+    MeshSnapshot<T>& MeshSnapshot<T>::operator=(MeshSnapshot&& other) noexcept
+    {
+        if (this != &other) {
+            close();
+            std::swap(_base, other._base);
+            std::swap(_size, other._size);
+            std::swap(_buffer, other._buffer);
+            std::swap(_header, other._header);
+            std::swap(_mesh, other._mesh);
+        }
+        return *this;
+    }
+
+    template<typename T>
+    bool MeshSnapshot<T>::open(const std::string& path)
+    {
+        using Index = typename Mesh<T>::Index;
+        close();
+#if KRS_POSIX
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        void* base = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(SnapshotHeader)) {
+            base = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (base == MAP_FAILED) {
+            return false;
+        }
+        _base = static_cast<const char*>(base);
+        _size = st.st_size;
+#else
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        const std::streamoff size = in ? std::streamoff(in.tellg()) : std::streamoff(0);
+        if (size < std::streamoff(sizeof(SnapshotHeader))) {
+            return false;
+        }
+        _buffer.resize((size_t(size) + 7) / 8);
+        in.seekg(0);
+        if (!in.read(reinterpret_cast<char*>(_buffer.data()), size)) {
+            _buffer = std::vector<std::uint64_t>();
+            return false;
+        }
+        _base = reinterpret_cast<const char*>(_buffer.data());
+        _size = size_t(size);
+#endif
+        std::memcpy(&_header, _base, sizeof(_header));
+
+        const SnapshotHeader& h = _header;
+        // the grid size is checked before it is multiplied out
+        bool ok = std::memcmp(h.magic, "KRSS", 4) == 0 && h.version == 1 && h.scalarSize == sizeof(T) && h.indexSize == sizeof(Index)
+            && h.size <= _size && h.vertices <= Mesh<T>::npos && h.triangles <= Mesh<T>::npos && h.gridCols > 0 && h.gridRows > 0
+            && h.gridCols <= _size / sizeof(Index) / h.gridRows && h.cellW > 0 && h.cellH > 0;
+        const std::uint64_t counts[6] = { h.vertices, h.triangles, h.triangles, h.hull, h.vertices, ok ? h.gridCols * h.gridRows : 0 };
+        const std::uint64_t sizes[6] = { sizeof(Vector2<T>), sizeof(std::array<Index, 3>), sizeof(std::array<Index, 3>), sizeof(Index), sizeof(Index), sizeof(Index) };
+        for (int i = 0; i < 6 && ok; i++) {
+            ok = h.sections[i] % 8 == 0 && counts[i] <= _size / sizes[i] && h.sections[i] <= _size - counts[i] * sizes[i];
+        }
+        // locate() starts its walk from a grid cell
+        const Index* grid = ok ? reinterpret_cast<const Index*>(_base + h.sections[5]) : nullptr;
+        for (std::uint64_t c = 0; c < counts[5] && ok; c++) {
+            ok = grid[c] < h.triangles || h.triangles == 0;
+        }
+        if (!ok) {
+            close();
+            return false;
+        }
+
+        auto section = [&](int i) { return _base + h.sections[i]; };
+        auto vertices = reinterpret_cast<const Vector2<T>*>(section(0));
+        auto triangles = reinterpret_cast<const std::array<Index, 3>*>(section(1));
+        auto neighbors = reinterpret_cast<const std::array<Index, 3>*>(section(2));
+        auto hull = reinterpret_cast<const Index*>(section(3));
+        auto incident = reinterpret_cast<const Index*>(section(4));
+        _mesh.vertices = View<Vector2<T>>(vertices, vertices + h.vertices);
+        _mesh.triangles = View<std::array<Index, 3>>(triangles, triangles + h.triangles);
+        _mesh.neighbors = View<std::array<Index, 3>>(neighbors, neighbors + h.triangles);
+        _mesh.hull = View<Index>(hull, hull + h.hull);
+        _mesh.incident = View<Index>(incident, incident + h.vertices);
+        return true;
+    }
 
-        const T circum_x = (ab * (cy - by) + cd * (ay - cy) + ef * (by - ay)) / (ax * (cy - by) + bx * (ay - cy) + cx * (by - ay));
-        const T circum_y = (ab * (cx - bx) + cd * (ax - cx) + ef * (bx - ax)) / (ay * (cx - bx) + by * (ax - cx) + cy * (bx - ax));
+    template<typename T>
+    void MeshSnapshot<T>::close()
+    {
+#if KRS_POSIX
+        if (_base) {
+            munmap(const_cast<char*>(_base), _size);
+        }
+#endif
+        _buffer = std::vector<std::uint64_t>();
+        _base = nullptr;
+        _size = 0;
+        _header = SnapshotHeader();
+        _mesh = MeshView<T>();
+    }
 
-        const VertexType circum(circum_x / 2, circum_y / 2);
-        const T circum_radius = a->dist2(circum);
-        const T dist = v.dist2(circum);
+    template<typename T>
+    MeshLocation MeshSnapshot<T>::locate(const Vector2<T>& p) const
+    {
+        using Index = typename Mesh<T>::Index;
+        if (!_base) {
+            return { MeshLocation::Outside, Mesh<T>::npos, 0 };
+        }
+        const SnapshotHeader& h = _header;
+        const double col = std::min(double(h.gridCols - 1), std::max(0.0, (double(p.x) - h.gridX) / h.cellW));
+        const double row = std::min(double(h.gridRows - 1), std::max(0.0, (double(p.y) - h.gridY) / h.cellH));
+        const Index* grid = reinterpret_cast<const Index*>(_base + h.sections[5]);
+        return locatePoint(_mesh, p, grid[std::uint64_t(row) * h.gridCols + std::uint64_t(col)]);
+    }
 
+    template<typename T>
+    bool MeshSnapshot<T>::validate() const
+    {
+        using Index = typename Mesh<T>::Index;
+        const Index nv = Index(_mesh.vertices.size()), nt = Index(_mesh.triangles.size());
+        for (size_t t = 0; t < nt; t++) {
+            for (int i = 0; i < 3; i++) {
+                const Index n = _mesh.neighbors[t][i];
+                if (_mesh.triangles[t][i] >= nv || (n >= nt && n != Mesh<T>::npos)) {
+                    return false;
+                }
+            }
+        }
+        for (Index v : _mesh.hull) {
+            if (v >= nv) {
+                return false;
+            }
+        }
+        for (Index t : _mesh.incident) {
+            if (t >= nt && t != Mesh<T>::npos) {
+                return false;
+            }
+        }
+        return _base != nullptr;
+    }
 
-        return dist <= circum_radius;
-    };
+    template<typename T>
+    Mesh<T> MeshSnapshot<T>::materialize() const
+    {
+        Mesh<T> mesh;
+        mesh.vertices = _mesh.vertices.materialize();
+        mesh.triangles = _mesh.triangles.materialize();
+        mesh.neighbors = _mesh.neighbors.materialize();
+        mesh.hull = _mesh.hull.materialize();
+        mesh.incident = _mesh.incident.materialize();
+        return mesh;
+    }
 
     template <typename T>
     class delaunay {
@@ -187,32 +2608,82 @@ namespace krs {
         using TriangleType = Triangle<T>;
 
         //std::vector<Edge<double>> _edges;
+        // the input of the last run in the order it was left in, vertex i of _mesh when it was built
         std::vector<Vector2<T>> _vertices;
         std::vector<std::pair<std::pair<T, T>, std::pair<T, T> >> _edges;
         std::vector<std::vector<std::pair<T, T>>> _triangles;
         std::vector<std::vector<std::pair<T, T>>> res;
+        std::vector<size_t> _yOrder;
+        // neighbor lists of all vertices back to back, vertex v owns [_neighborOffsets[v], _neighborOffsets[v + 1])
+        std::vector<typename Mesh<T>::Index> _neighborOffsets;
+        std::vector<typename Mesh<T>::Index> _neighbors;
+        // indexed topology for kinetic updates, authoritative over _edges while _edgesStale
+        Mesh<T> _mesh;
+        bool _edgesStale = false;
+        MeshSource _meshSource = MeshSource::None;
+        // checked on every potentials() step of a stoppable merge, _aborted records that it fired
+        std::function<bool()> _stop;
+        bool _aborted = false;
 
     public:
+        // slicingVector leaves and the largest chunk baseCase solves, the merges need the
+        // shallow 3, 4, 6 levels above them
+        static constexpr size_t leafSize = 3;
 
         delaunay() = default;
         delaunay(const delaunay&) = default;
         delaunay(delaunay&&) = default;
 
 
-        const std::vector<std::pair<std::pair<T, T>, std::pair<T, T> >> potentials(std::vector<VertexType>& vertices1, std::vector<VertexType>& vertices2
+        View<Edge<T>> potentials(std::vector<VertexType>& vertices1, std::vector<VertexType>& vertices2
         ,  std::pair<T, T> new_pair1, std::pair<T, T> new_pair2, bool isStart, int depth);
-
-        const std::vector<std::pair<std::pair<T, T>, std::pair<T, T> >> getEdges();
-        const std::vector<std::pair<std::pair<T, T>, std::pair<T, T> >> createEdges(std::vector<VertexType>& vertices);
-        const std::vector<std::pair<std::pair<T, T>, std::pair<T, T>>> slicingVector(std::vector<VertexType>& vertices, size_t b, size_t e);
+        View<Edge<T>> potentials(std::vector<VertexType>& vertices1, std::vector<VertexType>& vertices2,
+            const std::vector<size_t>& xorder1, const std::vector<size_t>& xorder2, std::pair<T, T> new_pair1, std::pair<T, T> new_pair2, bool isStart, int depth);
+        void presort(std::vector<VertexType>& vertices);
+        void orderRun(std::vector<VertexType>& vertices, std::vector<size_t>& xorder) const;
+        DelaunayReport<T> verify(const std::vector<VertexType>& vertices) const;
+
+        // the raw merge output of slicingVector, which need not be a triangulation, until the
+        // mesh is edited; getTriangles and getNeighbors describe getMesh() instead
+        View<Edge<T>> getEdges();
+        View<Edge<T>> createEdges(std::vector<VertexType>& vertices);
+        void baseCase(const VertexType* vertices, size_t n);
+        View<Edge<T>> slicingVector(std::vector<VertexType>& vertices, size_t b, size_t e);
+        TriangulationStatus slicingVector(std::vector<VertexType>& vertices, size_t b, size_t e, const TriangulationOptions& options);
+        // drops the mesh and everything derived from it, for a new run
+        void resetMesh();
+        // proceed() runs after every merge, returning false stops the level. stop() is polled
+        // inside each merge and leaves the one it interrupts half done, the caller restores _edges.
+        size_t mergeLevel(std::vector<VertexType>& vertices, size_t chunk, const std::function<bool()>& proceed = nullptr,
+            const std::function<bool()>& stop = nullptr);
+        // Delaunay triangulation in tiles solved by worker processes, one Hilbert-ordered pass
+        // where only one core is available. halo defaults to four mean point spacings.
+        View<Edge<T>> tiledTriangulation(std::vector<VertexType>& vertices, size_t tilesX, size_t tilesY, T halo = 0);
         bool isTriangle(std::vector<std::pair<std::pair<T, T>, std::pair<T, T> >> edges, std::pair<T, T> p1, std::pair<T, T> p2, std::pair<T, T> p3);
         bool onsegment(std::pair<T, T> p1, std::pair<T, T> p2, std::pair<T, T> p3) const;
         const int orientation(std::pair<T, T> p1, std::pair<T, T> p2, std::pair<T, T> p3) const;
         bool intersect(std::pair<T, T> p1, std::pair<T, T> p2, std::pair<T, T> q1, std::pair<T, T> q2) const;
         bool delaunay_intersect(std::pair<T, T> np1, std::pair<T, T> np2) const;
         void solve(size_t n, size_t k, std::vector<std::pair<T, T>> temp, size_t start, std::vector<Vector2<T>>& vertices);
-        const std::vector<std::vector<std::pair<T, T>>> combine(int n, int k, std::vector<Vector2<T>>& vertices);
-        const std::vector<std::vector<std::pair<T, T>>> getTriangles();
+        View<std::vector<std::pair<T, T>>> combine(int n, int k, std::vector<Vector2<T>>& vertices);
+        // triangles of getMesh(), so they match getEdges() only where meshSource() is Edges
+        View<std::array<typename Mesh<T>::Index, 3>> getTriangles();
+        // vertices sharing an edge with v in getMesh(), counterclockwise; see getTriangles
+        View<typename Mesh<T>::Index> getNeighbors(typename Mesh<T>::Index v);
+        // Vertex i is vertices[i] as the last slicingVector or tiledTriangulation left them
+        // (presorted by slicingVector), so these are the ids moveVertices takes.
+        const Mesh<T>& getMesh();
+        MeshSource meshSource() const { return _meshSource; }
+        KineticStats moveVertices(const std::vector<typename Mesh<T>::Index>& ids, const std::vector<VertexType>& positions);
+        MeshPermutation reorder(MeshOrder order);
+        RefinementStats refine(const RefinementOptions& options);
+        // values follow getMesh().vertices
+        std::vector<Contour<T>> contour(const std::vector<T>& values, const std::vector<T>& levels);
+        bool saveSnapshot(const std::string& path);
+        // getMesh() in the binary format of krs::writeMesh
+        bool writeMesh(std::ostream& out);
+        // replaces the current state with the snapshot's mesh
+        bool loadSnapshot(const MeshSnapshot<T>& snapshot);
         delaunay& operator=(delaunay&&) = default;
 
     };
@@ -220,132 +2691,686 @@ namespace krs {
 
 
     template<typename T>
-    const std::vector<std::pair<std::pair<T, T>, std::pair<T, T> >>
+    View<Edge<T>>
         delaunay<T>::getEdges()
     {
+        if (_edgesStale) {
+            _edges = meshEdges(_mesh);
+            _edgesStale = false;
+        }
         return _edges;
     }
 
+    template<typename T>
+    View<std::array<typename Mesh<T>::Index, 3>> delaunay<T>::getTriangles()
+    {
+        return getMesh().triangles;
+    }
+
+    // Built from the mesh on first use and dropped whenever the mesh changes.
+    template<typename T>
+    View<typename Mesh<T>::Index> delaunay<T>::getNeighbors(typename Mesh<T>::Index v)
+    {
+        using Index = typename Mesh<T>::Index;
+        const Mesh<T>& mesh = getMesh();
+        if (_neighborOffsets.size() != mesh.vertices.size() + 1) {
+            _neighborOffsets.assign(1, 0);
+            _neighbors.clear();
+            std::vector<Index> star;
+            for (Index u = 0; u < mesh.vertices.size(); u++) {
+                const bool interior = vertexStar(mesh, u, star);
+                for (Index t : star) {
+                    _neighbors.push_back(mesh.triangles[t][(vertexSlot(mesh, t, u) + 1) % 3]);
+                }
+                if (!interior && !star.empty()) {
+                    _neighbors.push_back(mesh.triangles[star.back()][(vertexSlot(mesh, star.back(), u) + 2) % 3]);
+                }
+                _neighborOffsets.push_back(static_cast<Index>(_neighbors.size()));
+            }
+        }
+        if (v >= mesh.vertices.size()) {
+            return View<Index>();
+        }
+        return View<Index>(_neighbors.data() + _neighborOffsets[v], _neighbors.data() + _neighborOffsets[v + 1]);
+    }
+
+    // Indexes _edges on first use, renumbered to follow _vertices. Edge lists that are not a
+    // triangulation are replaced by a triangulation of _vertices and ones that are not Delaunay
+    // are flipped; meshSource() tells which happened. getEdges keeps returning the merge output
+    // until the mesh is edited.
+    template<typename T>
+    const Mesh<T>& delaunay<T>::getMesh()
+    {
+        using Index = typename Mesh<T>::Index;
+        if (_mesh.vertices.empty() && !_edges.empty()) {
+            DelaunayReport<T> report;
+            const Mesh<T> built = buildMesh(_vertices, _edges, &report);
+            // of repeated points the first one is linked, as triangulatePoints does
+            std::map<std::pair<std::uint64_t, std::uint64_t>, Index> index;
+            for (size_t i = 0; i < _vertices.size(); i++) {
+                index.emplace(std::make_pair(radix_key(_vertices[i].x), radix_key(_vertices[i].y)), Index(i));
+            }
+            std::vector<Index> to(built.vertices.size(), Mesh<T>::npos);
+            bool mapped = report.uncoveredPoints.empty();
+            for (size_t v = 0; v < built.vertices.size() && mapped; v++) {
+                auto it = index.find(std::make_pair(radix_key(built.vertices[v].x), radix_key(built.vertices[v].y)));
+                mapped = it != index.end();
+                if (mapped) {
+                    to[v] = it->second;
+                }
+            }
+
+            if (!mapped || !report.planar() || !report.hullConvex || !report.hullCovered) {
+                _mesh = triangulatePoints(_vertices);
+                _meshSource = MeshSource::Retriangulated;
+            }
+            else {
+                _mesh.vertices = _vertices;
+                for (auto& t : built.triangles) {
+                    _mesh.triangles.push_back({ to[t[0]], to[t[1]], to[t[2]] });
+                }
+                connectMesh(_mesh);
+                _meshSource = legalizeEdges(_mesh, triangleEdges(_mesh.triangles)) > 0 ? MeshSource::Flipped : MeshSource::Edges;
+            }
+        }
+        return _mesh;
+    }
+
+    template<typename T>
+    void delaunay<T>::resetMesh()
+    {
+        _mesh = Mesh<T>();
+        _edgesStale = false;
+        _meshSource = MeshSource::None;
+        _neighborOffsets.clear();
+        _neighbors.clear();
+    }
+
+    // Renumbers the mesh for locality, getEdges and getTriangles follow the new order.
+    template<typename T>
+    MeshPermutation delaunay<T>::reorder(MeshOrder order)
+    {
+        getMesh();
+        const MeshPermutation perm = reorderMesh(_mesh, order);
+        _neighborOffsets.clear();
+        _edgesStale = true;
+        return perm;
+    }
+
+    // Refines the mesh in place, the Steiner points are appended after the existing vertices.
+    template<typename T>
+    RefinementStats delaunay<T>::refine(const RefinementOptions& options)
+    {
+        getMesh();
+        const RefinementStats stats = refineMesh(_mesh, options);
+        _neighborOffsets.clear();
+        _edgesStale = true;
+        return stats;
+    }
+
+    template<typename T>
+    std::vector<Contour<T>> delaunay<T>::contour(const std::vector<T>& values, const std::vector<T>& levels)
+    {
+        return contourMesh(getMesh(), values, levels);
+    }
+
+    template<typename T>
+    bool delaunay<T>::saveSnapshot(const std::string& path)
+    {
+        return writeSnapshotFile(path, getMesh());
+    }
+
+    template<typename T>
+    bool delaunay<T>::writeMesh(std::ostream& out)
+    {
+        return krs::writeMesh(out, getMesh());
+    }
+
+    template<typename T>
+    bool delaunay<T>::loadSnapshot(const MeshSnapshot<T>& snapshot)
+    {
+        if (!snapshot.isOpen()) {
+            return false;
+        }
+        resetMesh();
+        _mesh = snapshot.materialize();
+        _vertices = _mesh.vertices;
+        _edges.clear();
+        _edgesStale = true;
+        _meshSource = MeshSource::Snapshot;
+        return true;
+    }
+
+    // Moves existing vertices and repairs the mesh locally. Vertices whose move would invert a
+    // triangle or fold the hull are put back, the rest are fixed with flips, and then each of
+    // those is removed and reinserted at its new position.
+    template<typename T>
+    KineticStats delaunay<T>::moveVertices(const std::vector<typename Mesh<T>::Index>& ids, const std::vector<Vector2<T>>& positions)
+    {
+        using Index = typename Mesh<T>::Index;
+        const Index npos = Mesh<T>::npos;
+        KineticStats stats;
+        getMesh();
+        Mesh<T>& mesh = _mesh;
+
+        std::unordered_map<Index, std::pair<VertexType, VertexType>> moves;   // old, new
+        for (size_t k = 0; k < std::min(ids.size(), positions.size()); k++) {
+            const Index v = ids[k];
+            if (v >= mesh.vertices.size() || mesh.incident[v] == npos) {
+                continue;
+            }
+            auto it = moves.emplace(v, std::make_pair(mesh.vertices[v], positions[k])).first;
+            it->second.second = positions[k];
+            mesh.vertices[v] = positions[k];
+        }
+        stats.moved = moves.size();
+        if (moves.empty()) {
+            return stats;
+        }
+
+        std::unordered_map<Index, size_t> hullPos;
+        for (size_t i = 0; i < mesh.hull.size(); i++) {
+            hullPos[mesh.hull[i]] = i;
+        }
+        auto convexAt = [&](size_t i) {
+            const size_t h = mesh.hull.size();
+            return orient2d(mesh.vertices[mesh.hull[(i + h - 1) % h]], mesh.vertices[mesh.hull[i]], mesh.vertices[mesh.hull[(i + 1) % h]]) >= 0;
+        };
+
+        // put back every vertex that leaves an inverted triangle or a folded hull behind
+        std::vector<Index> star;
+        std::unordered_set<Index> crossed;
+        for (bool changed = true; changed;) {
+            changed = false;
+            for (auto& m : moves) {
+                const Index v = m.first;
+                if (crossed.count(v)) {
+                    continue;
+                }
+                bool broken = false;
+                vertexStar(mesh, v, star);
+                for (Index t : star) {
+                    const auto& tri = mesh.triangles[t];
+                    broken = broken || orient2d(mesh.vertices[tri[0]], mesh.vertices[tri[1]], mesh.vertices[tri[2]]) <= 0;
+                }
+                auto h = hullPos.find(v);
+                if (h != hullPos.end()) {
+                    const size_t n = mesh.hull.size();
+                    broken = broken || !convexAt((h->second + n - 1) % n) || !convexAt(h->second) || !convexAt((h->second + 1) % n);
+                }
+                if (broken) {
+                    mesh.vertices[v] = m.second.first;
+                    crossed.insert(v);
+                    changed = true;
+                }
+            }
+        }
+
+        std::vector<std::pair<Index, Index>> seeds;
+        for (auto& m : moves) {
+            if (crossed.count(m.first)) {
+                continue;
+            }
+            vertexStar(mesh, m.first, star);
+            for (Index t : star) {
+                const auto& tri = mesh.triangles[t];
+                seeds.push_back({ tri[0], tri[1] });
+                seeds.push_back({ tri[1], tri[2] });
+                seeds.push_back({ tri[2], tri[0] });
+            }
+        }
+        stats.flips += legalizeEdges(mesh, seeds);
+
+        for (Index v : crossed) {
+            const auto& m = moves[v];
+            vertexStar(mesh, v, star);
+            const Index near = mesh.triangles[star.front()][(vertexSlot(mesh, star.front(), v) + 1) % 3];
+            if (!removeVertex(mesh, v, &stats.flips)) {
+                stats.rebuilt = true;
+                break;
+            }
+            if (insertVertex(mesh, m.second, mesh.incident[near], v, &stats.flips) == npos) {
+                // the new position is taken by another vertex, stay where it was
+                insertVertex(mesh, m.first, mesh.incident[near], v, &stats.flips);
+            }
+            stats.relocated++;
+        }
+
+        if (stats.rebuilt) {
+            for (auto& m : moves) {
+                mesh.vertices[m.first] = m.second.second;
+            }
+            mesh = triangulatePoints(mesh.vertices);
+        }
+        _edgesStale = true;
+        _neighborOffsets.clear();
+        return stats;
+    }
+
 
     
 
    template<typename T>
-    const std::vector<std::pair<std::pair<T, T>, std::pair<T, T> >>
+    View<Edge<T>>
         delaunay<T>::slicingVector(std::vector<Vector2<T>>& vertices, size_t b, size_t e)
     {
-        std::pair<T, T> np1 = { 0,0 };
-        std::pair<T, T> np2 = { 0,0 };
-        std::vector<std::vector<Vector2<T>>> vlist;
-        for (auto i = 0; i < vertices.size(); i += 3) {
-            auto start = vertices.begin() + i;
-            auto end = vertices.begin() + i + 3;
-
-            std::vector<Vector2<T>> v(start, end);
-            vlist.push_back(v);
-            createEdges(v);
-        }   
-       
-        
-        for (auto i = 0; i < vlist.size()-1; i++)
-        {
-            potentials(vlist[i], vlist[i + 1], np1, np2, true, 0);
+        slicingVector(vertices, b, e, TriangulationOptions());
+        return _edges;
+
+    }
+
+    // Stops once the token is cancelled or the budget is spent, also in the middle of a merge.
+    // A level either runs to completion or is undone, so _edges always holds whole chunks of the
+    // last finished level.
+    template<typename T>
+    TriangulationStatus
+        delaunay<T>::slicingVector(std::vector<Vector2<T>>& vertices, size_t b, size_t e, const TriangulationOptions& options)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + options.budget;
+        const size_t n = vertices.size();
+
+        presort(vertices);
+        _edges.clear();
+        resetMesh();
+        _vertices = vertices;
+        for (size_t i = 0; i < n; i += leafSize) {
+            baseCase(vertices.data() + i, std::min(leafSize, n - i));
         }
 
+        // the original schedule, it stops at 12 since potentials() blows up on larger chunks
+        const std::vector<size_t> levels = { leafSize, 4, 6, 12 };
 
-      std::vector<std::vector<Vector2<T>>> vlist2;
-        for (auto i = 0; i < vertices.size(); i += 4) {
-             auto start = vertices.begin() + i;
-             auto end = vertices.begin() + i + 4;
+        TriangulationStatus status;
+        status.levels = levels.size();
+        for (size_t chunk : levels) {
+            status.mergesTotal += n > chunk ? (n - 1) / chunk : 0;
+        }
 
-             std::vector<Vector2<T>> v(start, end);
-             vlist2.push_back(v);
-         }
-        for (auto i = 0; i < vlist2.size() - 1; i++)
-        {
-            potentials(vlist2[i], vlist2[i + 1], np1, np2, true, 0);
+        const bool stoppable = options.token || options.budget > std::chrono::steady_clock::duration::zero();
+        const std::function<bool()> stop = [&]() {
+            status.cancelled = options.token && options.token->cancelled();
+            status.expired = options.budget > std::chrono::steady_clock::duration::zero() && std::chrono::steady_clock::now() >= deadline;
+            return status.cancelled || status.expired;
+        };
+        auto merged = [&]() {
+            status.mergesDone++;
+            if (options.progress) {
+                options.progress(status.mergesDone, status.mergesTotal);
+            }
+            return !stop();
+        };
+
+        for (size_t chunk : levels) {
+            // potentials() also erases earlier edges, so a level that does not finish is undone
+            decltype(_edges) saved;
+            const size_t before = status.mergesDone;
+            if (stoppable) {
+                saved = _edges;
+            }
+            const size_t pairs = stop() ? 0 : mergeLevel(vertices, chunk, merged, stoppable ? stop : nullptr);
+            if (pairs < (n > chunk ? (n - 1) / chunk : 0)) {
+                _edges.swap(saved);
+                status.mergesDone = before;
+                break;
+            }
+            status.levelsDone++;
         }
 
-        std::vector<std::vector<Vector2<T>>> vlist3;
-         for (auto i = 0; i < vertices.size(); i += 6) {
-             auto start = vertices.begin() + i;
-             auto end = vertices.begin() + i + 6;
+        status.complete = status.levelsDone == status.levels;
+        const size_t chunk = status.complete ? std::max<size_t>(n, 1) : levels[status.levelsDone == 0 ? 0 : status.levelsDone - 1];
+        for (size_t i = 0; i < n; i += chunk) {
+            status.regions.push_back({ i, std::min(i + chunk, n) });
+        }
+        return status;
+    }
 
-             std::vector<Vector2<T>> v(start, end);
-             vlist3.push_back(v);
-         }
-        
-         for (auto i = 0; i < vlist3.size() - 1; i++)
-         {
-             potentials(vlist3[i], vlist3[i + 1], np1, np2, true, 0);
-         }
-
-  /*       std::vector<std::vector<Vector2<T>>> vlist4;
-         for (auto i = 0; i < vertices.size(); i += 9) {
-             auto start = vertices.begin() + i;
-             auto end = vertices.begin() + i + 9;
-
-             std::vector<Vector2<T>> v(start, end);
-             vlist4.push_back(v);
-         }
-         
-         for (auto i = 0; i < vlist4.size() - 1; i++)
-         {
-             potentials(vlist4[i], vlist4[i + 1], np1, np2, true, 0);
-         }*/
-         std::vector<std::vector<Vector2<T>>> vlist5;
-         for (auto i = 0; i < vertices.size(); i += 12) {
-             auto start = vertices.begin() + i;
-             auto end = vertices.begin() + i + 12;
-
-             std::vector<Vector2<T>> v(start, end);
-             vlist5.push_back(v);
-         }
-   
-         for (auto i = 0; i < vlist5.size() - 1; i++)
-         {
-             potentials(vlist5[i], vlist5[i + 1], np1, np2, true, 0);
-         }
-         return _edges;
-     
+    template<typename T>
+    DelaunayReport<T>
+        delaunay<T>::verify(const std::vector<Vector2<T>>& vertices) const
+    {
+        return verifyDelaunay(vertices, _edgesStale ? meshEdges(_mesh) : _edges);
     }
-    template <typename T>
-    const std::vector<std::pair<std::pair<T,T>, std::pair<T,T> >> 
-        delaunay<T>::createEdges(std::vector<Vector2<T>>& vertices) {
 
-        
-        size_t s1 = vertices.size() - 1;
-        
-        if (s1 == 1) {
+    template<typename T>
+    size_t delaunay<T>::mergeLevel(std::vector<Vector2<T>>& vertices, size_t chunk, const std::function<bool()>& proceed,
+        const std::function<bool()>& stop)
+    {
+        std::pair<T, T> np1 = { 0,0 };
+        std::pair<T, T> np2 = { 0,0 };
+        // chunks are x-ranges of the presorted vertices, filled in y order
+        const size_t chunks = (vertices.size() + chunk - 1) / chunk;
+        std::vector<std::vector<Vector2<T>>> vlist(chunks);
+        std::vector<size_t> localY(vertices.size());
+        for (size_t i : _yOrder) {
+            localY[i] = vlist[i / chunk].size();
+            vlist[i / chunk].push_back(vertices[i]);
+        }
+        std::vector<std::vector<size_t>> xlist(chunks);
+        for (size_t i = 0; i < vertices.size(); i++) {
+            xlist[i / chunk].push_back(localY[i]);
+        }
+        for (size_t i = 0; i + 1 < vlist.size(); i++)
+        {
+            _stop = stop;
+            potentials(vlist[i], vlist[i + 1], xlist[i], xlist[i + 1], np1, np2, true, 0);
+            _stop = nullptr;
+            if (_aborted) {
+                _aborted = false;
+                return i;
+            }
+            if (proceed && !proceed()) {
+                return i + 1;
+            }
+        }
+        return vlist.empty() ? 0 : vlist.size() - 1;
+    }
+
+    template<typename T>
+    void delaunay<T>::presort(std::vector<Vector2<T>>& vertices)
+    {
+        std::vector<std::uint64_t> keys(vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++) {
+            keys[i] = radix_key(vertices[i].x);
+        }
+        const std::vector<size_t> byX = radix_order(keys);
+        std::vector<Vector2<T>> sorted(vertices.size());
+        for (size_t i = 0; i < byX.size(); i++) {
+            sorted[i] = vertices[byX[i]];
+        }
+        vertices.swap(sorted);
 
-            T firstx = vertices[0].x;
-            T firsty = vertices[0].y;
+        for (size_t i = 0; i < vertices.size(); i++) {
+            keys[i] = ~radix_key(vertices[i].y);
+        }
+        _yOrder = radix_order(keys);
+    }
 
-       
-            std::pair<T, T> pair1 = { firstx, firsty };
-            std::pair<T, T> pair2 = { vertices[s1].x , vertices[s1].y };
-           
-            _edges.push_back({ pair1, pair2 });
+    template<typename T>
+    void delaunay<T>::orderRun(std::vector<Vector2<T>>& vertices, std::vector<size_t>& xorder) const
+    {
+        std::vector<std::uint64_t> keys(vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++) {
+            keys[i] = ~radix_key(vertices[i].y);
+        }
+        const std::vector<size_t> byY = radix_order(keys);
+        std::vector<Vector2<T>> sorted(vertices.size());
+        for (size_t i = 0; i < byY.size(); i++) {
+            sorted[i] = vertices[byY[i]];
+        }
+        vertices.swap(sorted);
 
+        for (size_t i = 0; i < vertices.size(); i++) {
+            keys[i] = radix_key(vertices[i].x);
+        }
+        xorder = radix_order(keys);
+    }
 
+    template<typename T>
+    View<Edge<T>>
+        delaunay<T>::tiledTriangulation(std::vector<Vector2<T>>& vertices, size_t tilesX, size_t tilesY, T halo)
+    {
+        using Index = typename Mesh<T>::Index;
+        using Triangle = std::array<Index, 3>;
+        tilesX = std::max<size_t>(tilesX, 1);
+        tilesY = std::max<size_t>(tilesY, 1);
+        if (vertices.size() < 3 || tilesX * tilesY < 2) {
+            return slicingVector(vertices, 0, vertices.size() - 1);
+        }
+        auto finish = [&](Mesh<T>&& mesh, MeshSource source) {
+            resetMesh();
+            _mesh = std::move(mesh);
+            _vertices = vertices;
+            _edges = meshEdges(_mesh);
+            _meshSource = source;
+            return View<Edge<T>>(_edges);
+        };
+#if KRS_POSIX
+        const size_t batch = parallel_workers(vertices.size());
+#else
+        const size_t batch = 1;
+#endif
+        if (batch <= 1) {
+            // no second core to run tiles on, one Hilbert-ordered pass is faster than tiling
+            std::vector<Index> all(vertices.size());
+            std::iota(all.begin(), all.end(), Index(0));
+            return finish(triangulateSubset(vertices, all), MeshSource::Edges);
         }
-        else if (s1 == 2) {
 
+        T minx = vertices[0].x, maxx = vertices[0].x;
+        T miny = vertices[0].y, maxy = vertices[0].y;
+        for (auto& v : vertices) {
+            minx = std::min(minx, v.x); maxx = std::max(maxx, v.x);
+            miny = std::min(miny, v.y); maxy = std::max(maxy, v.y);
+        }
+        const T tileW = (maxx - minx) / tilesX;
+        const T tileH = (maxy - miny) / tilesY;
+        // a few mean point spacings hold the circumcircles of nearly every triangle near a seam
+        if (halo <= 0) {
+            halo = T(4 * std::sqrt(std::max(double(maxx - minx) * double(maxy - miny), 0.0) / vertices.size()));
+            halo = std::max({ halo, (maxx - minx) / 1024, (maxy - miny) / 1024 });
+        }
+        const double slack = 1e-9 * std::max({ 1.0, fabs(double(minx)), fabs(double(maxx)), fabs(double(miny)), fabs(double(maxy)) });
 
-            T firstx = vertices[0].x;
-            T firsty = vertices[0].y;
+        auto tileOf = [](T v, T lo, T w, size_t n) {
+            if (!(w > 0) || v <= lo) {
+                return size_t(0);
+            }
+            return std::min(static_cast<size_t>((v - lo) / w), n - 1);
+        };
+        const size_t tiles = tilesX * tilesY;
+        std::vector<std::uint32_t> owner(vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++) {
+            owner[i] = std::uint32_t(tileOf(vertices[i].y, miny, tileH, tilesY) * tilesX + tileOf(vertices[i].x, minx, tileW, tilesX));
+        }
 
-          
-            const std::pair<double, double> pair1 = { firstx, firsty };
-            const std::pair<double, double> pair2 = { vertices[s1-1].x , vertices[s1-1].y };
-            const std::pair<double, double> pair3 = { vertices[s1].x , vertices[s1].y };
-            
-            _edges.push_back({ pair1, pair2 });
-            _edges.push_back({ pair2, pair3 });
-            _edges.push_back({ pair3, pair1 });
+        // A tile triangulates its core plus a halo, the outer sides of the border tiles reach to
+        // infinity. Triangles whose circumcircle stays inside that rectangle see every point that
+        // could break them, so they are globally Delaunay ("certified"). Owned points still
+        // touching an uncertified triangle or the local hull are "open" and get stitched later.
+        auto solveTile = [&](size_t t, std::vector<Triangle>& certified, std::vector<Index>& open) {
+            const size_t tx = t % tilesX, ty = t / tilesX;
+            const double inf = std::numeric_limits<double>::infinity();
+            const double lox = tx == 0 ? -inf : double(minx + tileW * tx - halo);
+            const double hix = tx + 1 == tilesX ? inf : double(minx + tileW * (tx + 1) + halo);
+            const double loy = ty == 0 ? -inf : double(miny + tileH * ty - halo);
+            const double hiy = ty + 1 == tilesY ? inf : double(miny + tileH * (ty + 1) + halo);
+            std::vector<Index> ids;
+            for (size_t i = 0; i < vertices.size(); i++) {
+                const auto& v = vertices[i];
+                if (v.x >= lox && v.x <= hix && v.y >= loy && v.y <= hiy) {
+                    ids.push_back(Index(i));
+                }
+            }
+            const Mesh<T> local = triangulateSubset(vertices, ids);
+            // a tile without triangles leaves all its points open
+            std::vector<char> touched(ids.size(), local.triangles.empty());
+            for (auto v : local.hull) {
+                touched[v] = 1;
+            }
+            for (auto& tri : local.triangles) {
+                const auto& a = local.vertices[tri[0]];
+                const Vector2<double> o = circumcenter(a, local.vertices[tri[1]], local.vertices[tri[2]]);
+                const double r = std::sqrt((o.x - a.x) * (o.x - a.x) + (o.y - a.y) * (o.y - a.y)) + slack;
+                if (o.x - r > lox && o.x + r < hix && o.y - r > loy && o.y + r < hiy) {
+                    Triangle g = { ids[tri[0]], ids[tri[1]], ids[tri[2]] };
+                    std::rotate(g.begin(), std::min_element(g.begin(), g.end()), g.end());
+                    certified.push_back(g);
+                }
+                else {
+                    touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = 1;
+                }
+            }
+            for (size_t k = 0; k < ids.size(); k++) {
+                if (touched[k] && owner[ids[k]] == t) {
+                    open.push_back(ids[k]);
+                }
+            }
+        };
+
+        std::vector<std::vector<Triangle>> certified(tiles);
+        std::vector<std::vector<Index>> open(tiles);
+        std::vector<char> solved(tiles, 0);
+#if KRS_POSIX
+        // worker processes, at most one per hardware thread at a time, results come back over a
+        // local socket
+        for (size_t first = 0; first < tiles; first += batch) {
+            const size_t last = std::min(tiles, first + batch);
+            std::vector<int> fds(last - first, -1);
+            std::vector<pid_t> pids(last - first, -1);
+            for (size_t t = first; t < last; t++) {
+                int sv[2];
+                if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+                    continue;
+                }
+                pid_t pid = fork();
+                if (pid == 0) {
+                    close(sv[0]);
+                    std::vector<Triangle> c;
+                    std::vector<Index> o;
+                    solveTile(t, c, o);
+                    const std::uint64_t counts[2] = { c.size(), o.size() };
+                    const bool ok = writeAll(sv[1], counts, sizeof(counts)) && writeAll(sv[1], c.data(), c.size() * sizeof(Triangle))
+                        && writeAll(sv[1], o.data(), o.size() * sizeof(Index));
+                    close(sv[1]);
+                    _exit(ok ? 0 : 1);
+                }
+                close(sv[1]);
+                if (pid > 0) {
+                    fds[t - first] = sv[0];
+                    pids[t - first] = pid;
+                }
+                else {
+                    close(sv[0]);
+                }
+            }
+            for (size_t t = first; t < last; t++) {
+                const int fd = fds[t - first];
+                if (fd < 0) {
+                    continue;
+                }
+                std::uint64_t counts[2] = { 0, 0 };
+                bool ok = readAll(fd, counts, sizeof(counts)) && counts[0] <= vertices.size() * 2 && counts[1] <= vertices.size();
+                if (ok) {
+                    certified[t].resize(counts[0]);
+                    open[t].resize(counts[1]);
+                    ok = readAll(fd, certified[t].data(), counts[0] * sizeof(Triangle)) && readAll(fd, open[t].data(), counts[1] * sizeof(Index));
+                }
+                close(fd);
+                int status = 0;
+                waitpid(pids[t - first], &status, 0);
+                solved[t] = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+            }
+        }
+#endif
+        // tiles whose worker could not run
+        for (size_t t = 0; t < tiles; t++) {
+            if (!solved[t]) {
+                certified[t].clear();
+                open[t].clear();
+                solveTile(t, certified[t], open[t]);
+            }
+        }
 
+        // neighbouring tiles certify the same triangles near their seams
+        std::vector<Triangle> triangles;
+        std::vector<Index> seams;
+        for (size_t t = 0; t < tiles; t++) {
+            triangles.insert(triangles.end(), certified[t].begin(), certified[t].end());
+            seams.insert(seams.end(), open[t].begin(), open[t].end());
+        }
+        std::sort(triangles.begin(), triangles.end());
+        triangles.erase(std::unique(triangles.begin(), triangles.end()), triangles.end());
+        std::sort(seams.begin(), seams.end());
+
+        // certified triangles around each open point, back to back
+        std::vector<Index> first(vertices.size() + 1, 0);
+        for (auto v : seams) {
+            first[v + 1] = 1;
+        }
+        for (auto& g : triangles) {
+            for (auto v : g) {
+                first[v + 1] += first[v + 1] > 0;
+            }
+        }
+        for (size_t v = 0; v < vertices.size(); v++) {
+            first[v + 1] = first[v] + (first[v + 1] > 0 ? first[v + 1] - 1 : 0);
+        }
+        std::vector<Index> around(first.back()), fill(first.begin(), first.end() - 1);
+        for (size_t t = 0; t < triangles.size(); t++) {
+            for (auto v : triangles[t]) {
+                if (fill[v] < first[v + 1]) {
+                    around[fill[v]++] = Index(t);
+                }
+            }
+        }
+        // The open points' triangulation holds every missing triangle. Its other triangles cross
+        // a certified one, and do so at a shared corner, so a corner overlap rejects them.
+        auto inside = [&](Index a, Index u, Index d, Index w) {
+            return orient2d(vertices[a], vertices[u], vertices[d]) > 0 && orient2d(vertices[a], vertices[d], vertices[w]) > 0;
+        };
+        auto sameRay = [&](Index a, Index u, Index w) {
+            const auto& o = vertices[a];
+            return orient2d(o, vertices[u], vertices[w]) == 0
+                && (vertices[u].x - o.x) * (vertices[w].x - o.x) + (vertices[u].y - o.y) * (vertices[w].y - o.y) > 0;
+        };
+        auto overlaps = [&](const Triangle& r) {
+            for (int i = 0; i < 3; i++) {
+                const Index a = r[i], b = r[(i + 1) % 3], c = r[(i + 2) % 3];
+                for (Index k = first[a]; k < first[a + 1]; k++) {
+                    const auto& g = triangles[around[k]];
+                    const int j = g[0] == a ? 0 : g[1] == a ? 1 : 2;
+                    const Index p = g[(j + 1) % 3], q = g[(j + 2) % 3];
+                    if (inside(a, b, p, c) || inside(a, b, q, c) || inside(a, p, b, q) || inside(a, p, c, q)
+                        || (sameRay(a, b, p) && sameRay(a, c, q))) {
+                        return true;
+                    }
+                }
+            }
+            return false;
         };
+        const Mesh<T> residual = triangulateSubset(vertices, seams);
+        std::vector<Triangle> stitched;
+        for (auto& tri : residual.triangles) {
+            Triangle g = { seams[tri[0]], seams[tri[1]], seams[tri[2]] };
+            std::rotate(g.begin(), std::min_element(g.begin(), g.end()), g.end());
+            if (!std::binary_search(triangles.begin(), triangles.end(), g) && !overlaps(g)) {
+                stitched.push_back(g);
+            }
+        }
+        triangles.insert(triangles.end(), stitched.begin(), stitched.end());
+
+        Mesh<T> mesh;
+        mesh.vertices = vertices;
+        mesh.triangles = std::move(triangles);
+        connectMesh(mesh);
+        std::vector<Vector2<T>> distinct = vertices;
+        std::sort(distinct.begin(), distinct.end(), [](const Vector2<T>& a, const Vector2<T>& b) { return a.x < b.x || (a.x == b.x && a.y < b.y); });
+        const size_t unique = size_t(std::unique(distinct.begin(), distinct.end()) - distinct.begin());
+        const size_t linked = size_t(std::count_if(mesh.incident.begin(), mesh.incident.end(), [](Index t) { return t != Mesh<T>::npos; }));
+        if (linked != unique || !isTriangulation(mesh)) {
+            // the stitch did not close up, triangulate the whole set instead
+            return finish(triangulatePoints(vertices), MeshSource::Retriangulated);
+        }
+        // certified triangles are Delaunay already, only the stitch may need a flip
+        legalizeEdges(mesh, triangleEdges(stitched));
+        return finish(std::move(mesh), MeshSource::Edges);
+    }
+    template <typename T>
+    View<Edge<T>>
+        delaunay<T>::createEdges(std::vector<Vector2<T>>& vertices) {
+
+        baseCase(vertices.data(), vertices.size());
         return _edges;
     }
+
+    template<typename T>
+    void delaunay<T>::baseCase(const Vector2<T>* vertices, size_t n)
+    {
+        static constexpr auto solvers = baseCaseTable<T>(std::make_index_sequence<leafSize + 1>());
+        if (n < solvers.size()) {
+            solvers[n](vertices, _edges);
+        }
+    }
     template<typename T>
     bool delaunay<T>::onsegment(std::pair<T, T> p1, std::pair<T, T> p2, std::pair<T, T> p3) const
     {
@@ -417,7 +3442,7 @@ namespace krs {
         }
     }
     template<typename T>
-    const std::vector<std::vector<std::pair<T, T>>> 
+    View<std::vector<std::pair<T, T>>>
         delaunay<T>::combine(int n, int k, std::vector<Vector2<T>>& vertices) {
 
         res.clear();
@@ -430,16 +3455,30 @@ namespace krs {
 
 
     template <typename T>
-    const std::vector<std::pair<std::pair<T, T>, std::pair<T, T> >>
+    View<Edge<T>>
+        delaunay<T>::potentials(std::vector<Vector2<T>>& vertices1, std::vector<Vector2<T>>& vertices2,
+            std::pair<T, T> np1, std::pair<T, T> np2, bool isStart, int depth) {
+
+        std::vector<size_t> xorder1, xorder2;
+        orderRun(vertices1, xorder1);
+        orderRun(vertices2, xorder2);
+        return potentials(vertices1, vertices2, xorder1, xorder2, np1, np2, isStart, depth);
+    }
+
+    // vertices are in descending y order, xorder lists their positions in ascending x order
+    template <typename T>
+    View<Edge<T>>
         delaunay<T>::potentials(std::vector<Vector2<T>>& vertices1, std::vector<Vector2<T>>& vertices2,
+            const std::vector<size_t>& xorder1, const std::vector<size_t>& xorder2,
             std::pair<T, T> np1, std::pair<T, T> np2, bool isStart, int depth) {
 
+        if (_aborted || (_stop && _stop())) {
+            _aborted = true;
+            return _edges;
+        }
       
         if (isStart) {
 
-            std::sort(vertices1.begin(), vertices1.end(), [](Vector2<T> a, Vector2<T> b) { return a.y > b.y; });
-            std::sort(vertices2.begin(), vertices2.end(), [](Vector2<T> a, Vector2<T> b) { return a.y > b.y; });
-
             const VertexType p1(vertices1[0].x, vertices1[0].y);
             const VertexType p2(vertices2[0].x, vertices2[0].y);
 
@@ -462,6 +3501,7 @@ namespace krs {
             std::vector<Vector2<double>> Right_klist;
             bool isright = false;
             int rcount = 0;
+            std::vector<bool> rightCand(vertices2.size(), false);
             for (auto& k : vertices2)
             {
                 start++;
@@ -495,18 +3535,22 @@ namespace krs {
                     if (c == (vertices2.size() - start)) {
                         // potential is submitted
                         isright = true;
-                        Right_klist.push_back(k);
+                        rightCand[static_cast<size_t>(start) - 1] = true;
                         rcount++;
                     }
 
                 }
             }
+            for (size_t i : xorder2) {
+                if (rightCand[i]) Right_klist.push_back(vertices2[i]);
+            }
 
             ///******************  LL edge  *************************/
             start = 0;
             bool isleft = false;
             int lcount = 0;
             std::vector<Vector2<double>> Left_klist;
+            std::vector<bool> leftCand(vertices1.size(), false);
             for (auto& k : vertices1)
             {
                 start++;
@@ -536,7 +3580,7 @@ namespace krs {
                     if (c == (vertices1.size() - start)) {
                         // potential is submitted
                         isleft = true;
-                        Left_klist.push_back(k);
+                        leftCand[static_cast<size_t>(start) - 1] = true;
                         lcount++;
 
                     }
@@ -544,51 +3588,47 @@ namespace krs {
                 }
 
             }
+            for (auto i = xorder1.rbegin(); i != xorder1.rend(); i++) {
+                if (leftCand[*i]) Left_klist.push_back(vertices1[*i]);
+            }
            
             if (depth != vertices1.size()) {
                 if (isleft == true && isright == false) {
-                    std::sort(Left_klist.begin(), Left_klist.end(), [](Vector2<T> a, Vector2<T> b) { return a.x > b.x; });
 
                     for (auto& a : Left_klist) {
                         const std::pair<T, T> new_pair1 = { a.x, a.y };
                         const std::pair<T, T> new_pair2 = { vertices2[0].x, vertices2[0].y };
                         if (delaunay_intersect(new_pair1, new_pair2)) {
                             _edges.push_back({ new_pair1, new_pair2 });
-                            potentials(vertices1, vertices2, new_pair1, new_pair2, false, depth + 1);
+                            potentials(vertices1, vertices2, xorder1, xorder2, new_pair1, new_pair2, false, depth + 1);
                         }
                     } return _edges;
                 }
                 else if (isleft == false && isright == true) {
-                    std::sort(Right_klist.begin(), Right_klist.end(), [](Vector2<T> a, Vector2<T> b) { return a.x < b.x; });
 
                     for (auto& a : Right_klist) {
                         const std::pair<T, T> new_pair1 = { vertices1[0].x, vertices1[0].y };
                         const std::pair<T, T> new_pair2 = { a.x, a.y };
                         if (delaunay_intersect(new_pair1, new_pair2)) {
                             _edges.push_back({ new_pair1, new_pair2 });
-                            potentials(vertices1, vertices2, new_pair1, new_pair2, false, depth + 1);
+                            potentials(vertices1, vertices2, xorder1, xorder2, new_pair1, new_pair2, false, depth + 1);
                         }
                     }
                 }
                 else if (isleft == true && isright == true) {
-                    std::sort(Left_klist.begin(), Left_klist.end(), [](Vector2<T> a, Vector2<T> b) { return a.x > b.x; });
-                    std::sort(Right_klist.begin(), Right_klist.end(), [](Vector2<T> a, Vector2<T> b) { return a.x < b.x; });
                     const TriangleType t = TriangleType{ p1, p2, Left_klist[0] };
                     if (!t.circumCircleContains(Right_klist[0])) {
-                        std::sort(Right_klist.begin(), Right_klist.end(), [](Vector2<T> a, Vector2<T> b) { return a.x < b.x; });
                         for (auto& a : Right_klist) {
                             const std::pair<T, T> new_pair1 = { vertices1[0].x, vertices1[0].y };
                             const std::pair<T, T> new_pair2 = { a.x, a.y };
                             if (delaunay_intersect(new_pair1, new_pair2)) {
                                 _edges.push_back({ new_pair1, new_pair2 });
-                                potentials(vertices1, vertices2, new_pair1, new_pair2, false, depth + 1);
+                                potentials(vertices1, vertices2, xorder1, xorder2, new_pair1, new_pair2, false, depth + 1);
                             }
                         }
                     }
                     else {
 
-                        std::sort(Left_klist.begin(), Left_klist.end(), [](Vector2<T> a, Vector2<T> b) { return a.x > b.x; });
-                        std::sort(Right_klist.begin(), Right_klist.end(), [](Vector2<T> a, Vector2<T> b) { return a.x < b.x; });
                         const TriangleType t = TriangleType{ p1, p2, Right_klist[0] };
                         if (!t.circumCircleContains(Left_klist[0])) {
 
@@ -597,7 +3637,7 @@ namespace krs {
                                 const std::pair<T, T> new_pair2 = { vertices2[0].x, vertices2[0].y };
                                 if (delaunay_intersect(new_pair1, new_pair2)) {
                                     _edges.push_back({ new_pair1, new_pair2 });
-                                    potentials(vertices1, vertices2, new_pair1, new_pair2, false, depth + 1);
+                                    potentials(vertices1, vertices2, xorder1, xorder2, new_pair1, new_pair2, false, depth + 1);
                                 }
                             }
                         } return _edges;
@@ -629,6 +3669,7 @@ namespace krs {
                 std::vector<Vector2<double>> Right_klist;
                 bool isright = false;
                 int rcount = 0;
+                std::vector<bool> rightCand(vertices2.size(), false);
                 for (auto& k : vertices2)
                 {
                     start++;
@@ -662,18 +3703,22 @@ namespace krs {
                         if (c == (vertices2.size() - start)) {
                             // potential is submitted
                             isright = true;
-                            Right_klist.push_back(k);
+                            rightCand[static_cast<size_t>(start) - 1] = true;
                             rcount++;
                         }
 
                     }
                 }
+                for (size_t i : xorder2) {
+                    if (rightCand[i]) Right_klist.push_back(vertices2[i]);
+                }
 
                 ///******************  LL edge  *************************/
                 start = 0;
                 bool isleft = false;
                 int lcount = 0;
                 std::vector<Vector2<double>> Left_klist;
+                std::vector<bool> leftCand(vertices1.size(), false);
                 for (auto& k : vertices1)
                 {
                     start++;
@@ -705,19 +3750,21 @@ namespace krs {
                         if (c == (vertices1.size() - start)) {
                             // potential is submitted
                             isleft = true;
-                            Left_klist.push_back(k);
+                            leftCand[static_cast<size_t>(start) - 1] = true;
                             lcount++;
                         }
 
                     }
                 }
+                for (auto i = xorder1.rbegin(); i != xorder1.rend(); i++) {
+                    if (leftCand[*i]) Left_klist.push_back(vertices1[*i]);
+                }
 
 
        
 
                if (depth != vertices1.size()) {
                     if (isleft == true && isright == false) {
-                        std::sort(Left_klist.begin(), Left_klist.end(), [](Vector2<T> a, Vector2<T> b) { return a.x > b.x; });
                         for (auto& a : Left_klist) {
 
                             const std::pair<T, T> new_pair1 = { a.x, a.y };
@@ -725,21 +3772,20 @@ namespace krs {
 
                             if (delaunay_intersect(new_pair1, new_pair2)) { 
                                 _edges.push_back({ new_pair1, new_pair2 });
-                                potentials(vertices1, vertices2, new_pair1, new_pair2, false, depth + 1);
+                                potentials(vertices1, vertices2, xorder1, xorder2, new_pair1, new_pair2, false, depth + 1);
                             }
                         }
                         return _edges;
                        
                     }
                     else if (isleft == false && isright == true) {
-                        std::sort(Right_klist.begin(), Right_klist.end(), [](Vector2<T> a, Vector2<T> b) { return a.x < b.x; });
 
                         for (auto &a: Right_klist) {
                             const std::pair<T, T> new_pair1 = { np1.first, np1.second };
                             const std::pair<T, T> new_pair2 = { a.x, a.y };
                             if (delaunay_intersect(new_pair1, new_pair2)) {
                                 _edges.push_back({ new_pair1, new_pair2 });
-                                potentials(vertices1, vertices2, new_pair1, new_pair2, false, depth + 1);
+                                potentials(vertices1, vertices2, xorder1, xorder2, new_pair1, new_pair2, false, depth + 1);
                             }
 
                         } return _edges;
@@ -747,8 +3793,6 @@ namespace krs {
                     }
                     else if (isleft == true && isright == true) {
 
-                        std::sort(Left_klist.begin(), Left_klist.end(), [](Vector2<T> a, Vector2<T> b) { return a.x > b.x; });
-                        std::sort(Right_klist.begin(), Right_klist.end(), [](Vector2<T> a, Vector2<T> b) { return a.x < b.x; });
                         const TriangleType t = TriangleType{ p1, p2, Left_klist[0] };
 
                         if (!t.circumCircleContains(Right_klist[0])) {
@@ -758,14 +3802,12 @@ namespace krs {
                                 const std::pair<T, T> new_pair2 = { np2.first, np2.second };
                                 if (delaunay_intersect(new_pair1, new_pair2)) {
                                     _edges.push_back({ new_pair1, new_pair2 });
-                                    potentials(vertices1, vertices2, new_pair1, new_pair2, false, depth + 1);
+                                    potentials(vertices1, vertices2, xorder1, xorder2, new_pair1, new_pair2, false, depth + 1);
                                 }
                             } 
                         }
                         else {
 
-                            std::sort(Left_klist.begin(), Left_klist.end(), [](Vector2<T> a, Vector2<T> b) { return a.x > b.x; });
-                            std::sort(Right_klist.begin(), Right_klist.end(), [](Vector2<T> a, Vector2<T> b) { return a.x < b.x; });
                             const TriangleType t = TriangleType{ p1, p2, Right_klist[0] };
                             if (!t.circumCircleContains(Left_klist[0])) {
 
@@ -774,7 +3816,7 @@ namespace krs {
                                     const std::pair<T, T> new_pair2 = { a.x, a.y };
                                     if (delaunay_intersect(new_pair1, new_pair2)) {
                                         _edges.push_back({ new_pair1, new_pair2 });
-                                        potentials(vertices1, vertices2, new_pair1, new_pair2, false, depth + 1);
+                                        potentials(vertices1, vertices2, xorder1, xorder2, new_pair1, new_pair2, false, depth + 1);
                                     }
 
                                 }
@@ -808,10 +3850,6 @@ int main() {
    for (int i = 0; i < 24; ++i) {
         points.push_back(krs::Vector2<double>{dist_w(gen), dist_h(gen)});
     }
-    std::sort(points.begin(), points.end(), [](krs::Vector2<double> a, krs::Vector2<double> b) { return a.x < b.x; });
-    for (auto& a : points) {
-        std::cout << "[" << a.x << ", " << a.y << "] ";
-    }
 
 
 
@@ -828,12 +3866,16 @@ int main() {
 
 
     //delaunay.partition(points, 0, size);
-    std::vector<std::pair<std::pair<double, double>, std::pair<double, double> >> edges = delaunay.slicingVector(points, 0, size);
+    auto edges = delaunay.slicingVector(points, 0, size);
+    // slicingVector leaves points presorted by x
+    for (auto& a : points) {
+        std::cout << "[" << a.x << ", " << a.y << "] ";
+    }
     //std::vector<std::pair<std::pair<double, double>, std::pair<double, double> >> edges = delaunay.getEdges();
     std::cout << std::endl;
 
     std::vector<std::vector<std::pair<double, double>>> triangles;
-    std::vector<std::vector<std::pair<double, double>>> comb = delaunay.combine(24, 3, points);
+    auto comb = delaunay.combine(24, 3, points);
    
     for (int i = 0; i < comb.size(); i++) {
         std::vector<std::pair<double, double>> plist;
@@ -866,6 +3908,7 @@ int main() {
         
     }
     std::cout << triangles.size() << std::endl;
+    std::cout << delaunay.verify(points);
   /*  for (auto& e : edges) {
         std::cout << "(" << e.first.first << ", " << e.first.second << ")" << " (" << e.second.first << ", " << e.second.second << ")" << std::endl;
     }